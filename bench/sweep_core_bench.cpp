@@ -0,0 +1,375 @@
+// bench/sweep_core_bench.cpp
+// sweep_core 热路径微基准 + ticks_eth.csv 整段回放
+//
+//   ./sweep_core_bench                                   # 全部
+//   ./sweep_core_bench --benchmark_filter=Replay         # 只跑回放
+//   ./sweep_core_bench --benchmark_out=bench.json --benchmark_out_format=json
+//
+// 回放数据默认取源码目录的 ticks_eth.csv，环境变量 SWEEP_BENCH_TICKS 可覆盖
+// 微基准用固定种子的合成数据，结果不依赖数据文件，可以跨提交比较
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "backtester.h"
+#include "event_journal.h"
+#include "mean_reversion_strategy.h"
+#include "strategy_bank.h"
+#include "orderflow_features.h"
+#include "sweep_model.h"
+#include "tick_csv.h"
+#include "volume_windows.h"
+
+#ifndef SWEEP_BENCH_TICKS
+#define SWEEP_BENCH_TICKS "ticks_eth.csv"
+#endif
+
+namespace {
+
+constexpr double kTickSize = 0.01;
+constexpr double kMid = 3000.0;
+
+// 合成成交：约 20 笔/秒，价格按 tick 随机游走，量为对数正态
+std::vector<Tick> synthetic_ticks(std::size_t n) {
+    std::mt19937_64 rng(42);
+    std::exponential_distribution<double> gap(20.0);
+    std::lognormal_distribution<double> vol(-1.0, 1.2);
+    std::uniform_int_distribution<int> step(-2, 2);
+    std::bernoulli_distribution buy(0.5);
+
+    std::vector<Tick> out(n);
+    double ts = 1.7e9, px = kMid;
+    for (Tick& t : out) {
+        ts += gap(rng);
+        px += step(rng) * kTickSize;
+        t = {ts, px, vol(rng), buy(rng) ? Side::Buy : Side::Sell};
+    }
+    return out;
+}
+
+const std::vector<Tick>& micro_ticks() {
+    static const std::vector<Tick> ticks = synthetic_ticks(1 << 16);
+    return ticks;
+}
+
+// 回放数据（列式），进程内只读一次
+struct ReplayData {
+    TickBatch cols;
+    std::string error;
+};
+
+const ReplayData& replay_data() {
+    static const ReplayData data = [] {
+        ReplayData d;
+        const char* env = std::getenv("SWEEP_BENCH_TICKS");
+        std::string path = env ? env : SWEEP_BENCH_TICKS;
+        try {
+            TickCsvReader reader(path);
+            TickBatch batch;
+            while (reader.next(batch)) {
+                d.cols.ts.insert(d.cols.ts.end(), batch.ts.begin(), batch.ts.end());
+                d.cols.price.insert(d.cols.price.end(), batch.price.begin(), batch.price.end());
+                d.cols.volume.insert(d.cols.volume.end(), batch.volume.begin(), batch.volume.end());
+                d.cols.side.insert(d.cols.side.end(), batch.side.begin(), batch.side.end());
+            }
+        } catch (const std::exception& e) {
+            d.error = e.what();
+        }
+        if (d.error.empty() && d.cols.size() == 0) d.error = "no ticks in " + path;
+        return d;
+    }();
+    return data;
+}
+
+// 两侧各 depth 档、围绕 kMid 的初始盘口（N×2 price,size）
+void build_book(OrderFlowFeatureExtractor& ex, int depth) {
+    std::vector<double> bids, asks;
+    for (int i = 0; i < depth; ++i) {
+        bids.push_back(kMid - (i + 1) * kTickSize);
+        bids.push_back(1.0 + i % 7);
+        asks.push_back(kMid + i * kTickSize);
+        asks.push_back(1.0 + i % 5);
+    }
+    ex.apply_l2_snapshot(bids.data(), depth, asks.data(), depth);
+}
+
+void report_ticks(benchmark::State& state, std::size_t ticks_per_iter) {
+    double n = static_cast<double>(ticks_per_iter);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ticks_per_iter));
+    state.counters["ticks_per_sec"] = benchmark::Counter(n, benchmark::Counter::kIsIterationInvariantRate);
+    // 倒数计数器单位是秒，控制台显示为 ns（JSON 里是秒）
+    state.counters["time_per_tick"] = benchmark::Counter(
+        n, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+// ---------------- 微基准 ----------------
+
+void BM_SweepModel_ProcessTick(benchmark::State& state) {
+    const auto& ticks = micro_ticks();
+    SweepModel model(0.3, 10.0, 3.0);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.process_tick(ticks[i]));
+        if (++i == ticks.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SweepModel_ProcessTick);
+
+// 参数：SweepBaseline、long_window_sec；数据循环时时间戳整体后移，长基线也一直在稳态
+void BM_SweepModel_Baseline(benchmark::State& state) {
+    const auto& ticks = micro_ticks();
+    SweepModel model(0.3, static_cast<double>(state.range(1)), 3.0,
+                     static_cast<SweepBaseline>(state.range(0)));
+    const double span = ticks.back().timestamp - ticks.front().timestamp + 0.001;
+    double offset = 0.0;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        Tick t = ticks[i];
+        t.timestamp += offset;
+        benchmark::DoNotOptimize(model.process_tick(t));
+        if (++i == ticks.size()) {
+            i = 0;
+            offset += span;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SweepModel_Baseline)
+    ->ArgNames({"baseline", "long_sec"})
+    ->Args({0, 10})->Args({0, 600})->Args({1, 600})->Args({2, 600});
+
+void BM_Extractor_AddTrade(benchmark::State& state) {
+    const auto& ticks = micro_ticks();
+    OrderFlowFeatureExtractor ex(1.0, 3.0, 10.0, kTickSize);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const Tick& t = ticks[i];
+        ex.add_trade(t.timestamp, t.price, t.volume, t.side);
+        if (++i == ticks.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Extractor_AddTrade);
+
+// 盘口 depth 档；每次迭代取一次特征帧（含多档深度带）
+void BM_Extractor_GetFrame(benchmark::State& state) {
+    const auto& ticks = micro_ticks();
+    OrderFlowFeatureExtractor ex(1.0, 3.0, 10.0, kTickSize);
+    build_book(ex, static_cast<int>(state.range(0)));
+    for (std::size_t k = 0; k < 2000; ++k) {
+        const Tick& t = ticks[k];
+        ex.add_trade(t.timestamp, t.price, t.volume, t.side);
+    }
+    double ts = ticks[1999].timestamp;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ex.get_frame(ts));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Extractor_GetFrame)->Arg(50)->Arg(200)->Arg(1000);
+
+// 典型 delta：两侧各改一档（范围在盘口 depth 内，含少量删档 / 重新挂单）
+void BM_Extractor_ApplyL2Delta(benchmark::State& state) {
+    int depth = static_cast<int>(state.range(0));
+    OrderFlowFeatureExtractor ex(1.0, 3.0, 10.0, kTickSize);
+    build_book(ex, depth);
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> level(0, depth - 1);
+    std::uniform_int_distribution<int> size(0, 9);
+    constexpr std::size_t kDeltas = 4096;
+    std::vector<double> bids(2 * kDeltas), asks(2 * kDeltas);
+    for (std::size_t k = 0; k < kDeltas; ++k) {
+        bids[2 * k] = kMid - (level(rng) + 1) * kTickSize;
+        bids[2 * k + 1] = size(rng);
+        asks[2 * k] = kMid + level(rng) * kTickSize;
+        asks[2 * k + 1] = size(rng);
+    }
+
+    std::size_t k = 0;
+    for (auto _ : state) {
+        ex.apply_l2_delta(&bids[2 * k], 1, &asks[2 * k], 1);
+        if (++k == kDeltas) k = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Extractor_ApplyL2Delta)->Arg(50)->Arg(200)->Arg(1000);
+
+// 每 64 笔来一次 sweep，让 on_tick 大部分时间处在持仓 / 等待入场状态
+void BM_Strategy_OnTick(benchmark::State& state) {
+    const auto& ticks = micro_ticks();
+    MeanReversionStrategy strategy(5.0, 15.0, 1.0, 8.0);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const Tick& t = ticks[i];
+        if ((i & 63) == 0) {
+            SweepEventMeta ev{t.timestamp - 0.3, t.timestamp, t.price, t.price, 10.0,
+                              (i & 64) ? 1 : -1};
+            benchmark::DoNotOptimize(strategy.on_sweep(ev));
+        }
+        benchmark::DoNotOptimize(strategy.on_tick(t.timestamp, t.price));
+        if (++i == ticks.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Strategy_OnTick);
+
+// 同一路 sweep / 成交驱动 range(0) 组参数，节奏同 Strategy_OnTick
+void BM_StrategyBank_OnTick(benchmark::State& state) {
+    const auto& ticks = micro_ticks();
+    StrategyBank bank;
+    for (int k = 0; k < state.range(0); ++k) {
+        bank.add(MeanReversionStrategy(k % 4 * 50.0, 5.0 + k % 3 * 5.0, 1.0 + k % 5, 4.0 + k % 7));
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const Tick& t = ticks[i];
+        if ((i & 63) == 0) {
+            SweepEventMeta ev{t.timestamp - 0.3, t.timestamp, t.price, t.price, 10.0,
+                              (i & 64) ? 1 : -1};
+            benchmark::DoNotOptimize(bank.on_sweep(ev).size());
+        }
+        benchmark::DoNotOptimize(bank.on_tick(t.timestamp, t.price).size());
+        if (++i == ticks.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StrategyBank_OnTick)->Arg(8)->Arg(64);
+
+// 实盘路径记录一条动作（领槽 + 64 字节拷贝）；写满前换一个新文件，换文件不计时
+void BM_EventJournal_RecordAction(benchmark::State& state) {
+    const std::string path = "/tmp/sweep_core_bench.journal";
+    const uint64_t capacity = 1 << 18;
+    std::remove(path.c_str());
+    auto journal = std::make_unique<EventJournal>(path, capacity);
+    StrategyAction act{StrategyActionType::OpenLong, 1, 3000.0, 1700000000.0};
+    uint64_t n = 0;
+    for (auto _ : state) {
+        if (n == capacity) {
+            state.PauseTiming();
+            journal.reset();
+            std::remove(path.c_str());
+            journal = std::make_unique<EventJournal>(path, capacity);
+            n = 0;
+            state.ResumeTiming();
+        }
+        act.ts += 0.001;
+        benchmark::DoNotOptimize(journal->record_action(act));
+        ++n;
+    }
+    journal.reset();
+    std::remove(path.c_str());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EventJournal_RecordAction);
+
+// ---------------- 整段回放 ----------------
+
+// SweepModel + MeanReversionStrategy（与 offline_backtest.py 相同参数）
+void BM_Replay_Backtester(benchmark::State& state) {
+    const ReplayData& d = replay_data();
+    if (!d.error.empty()) {
+        state.SkipWithError(d.error.c_str());
+        return;
+    }
+    for (auto _ : state) {
+        Backtester bt(SweepModel(0.3, 10.0, 1.0), MeanReversionStrategy(5.0, 15.0, 1.0, 8.0));
+        bt.run(d.cols.ts.data(), d.cols.price.data(), d.cols.volume.data(), d.cols.side.data(),
+               d.cols.size());
+        benchmark::DoNotOptimize(bt.stats().cum_pnl_bp);
+    }
+    report_ticks(state, d.cols.size());
+}
+BENCHMARK(BM_Replay_Backtester)->Unit(benchmark::kMillisecond);
+
+// 同上，加成交模拟（只有成交数据：延迟 + 手续费 + 按到达时的最新成交价），看模拟本身的开销
+void BM_Replay_BacktesterFill(benchmark::State& state) {
+    const ReplayData& d = replay_data();
+    if (!d.error.empty()) {
+        state.SkipWithError(d.error.c_str());
+        return;
+    }
+    FillModel fill;
+    fill.latency = LatencyDist::Exponential;
+    fill.latency_ms = 20.0;
+    fill.jitter_ms = 30.0;
+    fill.taker_fee_bp = 5.5;
+    for (auto _ : state) {
+        Backtester bt(SweepModel(0.3, 10.0, 1.0), MeanReversionStrategy(5.0, 15.0, 1.0, 8.0), fill);
+        bt.run(d.cols.ts.data(), d.cols.price.data(), d.cols.volume.data(), d.cols.side.data(),
+               d.cols.size());
+        benchmark::DoNotOptimize(bt.stats().cum_pnl_bp);
+    }
+    report_ticks(state, d.cols.size());
+}
+BENCHMARK(BM_Replay_BacktesterFill)->Unit(benchmark::kMillisecond);
+
+// 实盘路径的逐笔计算：sweep 检测 -> on_sweep -> add_trade -> on_tick，每 100 笔取一次特征帧
+void BM_Replay_Pipeline(benchmark::State& state) {
+    const ReplayData& d = replay_data();
+    if (!d.error.empty()) {
+        state.SkipWithError(d.error.c_str());
+        return;
+    }
+    const TickBatch& c = d.cols;
+    for (auto _ : state) {
+        SweepModel model(0.3, 10.0, 1.0);
+        MeanReversionStrategy strategy(5.0, 15.0, 1.0, 8.0);
+        OrderFlowFeatureExtractor ex(1.0, 3.0, 10.0, kTickSize);
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            Tick t{c.ts[i], c.price[i], c.volume[i], c.side[i] > 0 ? Side::Buy : Side::Sell};
+            if (model.process_tick(t) != SweepSignal::NoSignal) {
+                benchmark::DoNotOptimize(strategy.on_sweep(model.get_last_event()));
+            }
+            ex.add_trade(t.timestamp, t.price, t.volume, t.side);
+            benchmark::DoNotOptimize(strategy.on_tick(t.timestamp, t.price));
+            if (i % 100 == 0) benchmark::DoNotOptimize(ex.get_frame(t.timestamp));
+        }
+    }
+    report_ticks(state, c.size());
+}
+BENCHMARK(BM_Replay_Pipeline)->Unit(benchmark::kMillisecond);
+
+// 离线回填：每 100ms 一个查询时刻，5 个 horizon；参数为 VolumeKernel，本机不支持的跳过
+void BM_WindowVolumes(benchmark::State& state) {
+    const ReplayData& d = replay_data();
+    if (!d.error.empty()) {
+        state.SkipWithError(d.error.c_str());
+        return;
+    }
+    VolumeKernel kernel = static_cast<VolumeKernel>(state.range(0));
+    state.SetLabel(volume_kernel_name(kernel == VolumeKernel::Auto ? best_volume_kernel() : kernel));
+    const TickBatch& c = d.cols;
+    std::vector<double> query;
+    for (double t = c.ts.front(); t <= c.ts.back(); t += 0.1) query.push_back(t);
+    const double horizons[] = {5.0, 10.0, 20.0, 30.0, 60.0};
+    std::vector<double> buy(query.size() * 5), sell(query.size() * 5);
+    for (auto _ : state) {
+        try {
+            compute_window_volumes(c.ts.data(), c.volume.data(), c.side.data(), c.size(),
+                                   query.data(), query.size(), horizons, 5,
+                                   buy.data(), sell.data(), nullptr, nullptr, kernel);
+        } catch (const std::invalid_argument& e) {
+            state.SkipWithError(e.what());
+            return;
+        }
+        benchmark::DoNotOptimize(buy.data());
+    }
+    report_ticks(state, c.size());
+}
+BENCHMARK(BM_WindowVolumes)
+    ->Arg(static_cast<int>(VolumeKernel::Scalar))
+    ->Arg(static_cast<int>(VolumeKernel::AVX2))
+    ->Arg(static_cast<int>(VolumeKernel::AVX512))
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
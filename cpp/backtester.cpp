@@ -0,0 +1,149 @@
+// cpp/backtester.cpp
+#include "backtester.h"
+
+#include <stdexcept>
+
+#include "trade_book_merge.h"
+
+Backtester::Backtester(const SweepDetector& detector, const MeanReversionStrategy& strategy)
+    : detector_(detector.clone()), strategy_(strategy) {}
+
+Backtester::Backtester(const SweepDetector& detector, const MeanReversionStrategy& strategy,
+                       const FillModel& fill)
+    : detector_(detector.clone()),
+      strategy_(strategy),
+      fill_(std::make_unique<FillSimulator>(fill)),
+      book_(fill.tick_size) {}
+
+void Backtester::handle_action(const StrategyAction& act) {
+    if (fill_) {
+        fill_->submit(act);
+        return;
+    }
+    switch (act.type) {
+    case StrategyActionType::OpenLong:
+    case StrategyActionType::OpenShort:
+        open_ = true;
+        open_dir_ = act.dir;
+        open_ts_ = act.ts;
+        open_price_ = act.price;
+        ++stats_.opens;
+        break;
+    case StrategyActionType::Close:
+        close_trade(act.ts, act.price, 0.0);
+        break;
+    case StrategyActionType::Idle:
+        break;
+    }
+}
+
+void Backtester::close_trade(double ts, double price, double fee_bp) {
+    if (!open_) return;
+    TradeRecord tr;
+    tr.entry_ts = open_ts_;
+    tr.exit_ts = ts;
+    tr.entry_price = open_price_;
+    tr.exit_price = price;
+    tr.dir = open_dir_;
+    tr.pnl_bp = (price - open_price_) / open_price_ * 10000.0 * open_dir_;
+    // 手续费按各自成交额收取，折算到开仓价的 bp
+    if (fill_) tr.pnl_bp -= open_fee_bp_ + fee_bp * price / open_price_;
+    trades_.push_back(tr);
+
+    stats_.cum_pnl_bp += tr.pnl_bp;
+    if (tr.pnl_bp > 0.0) {
+        ++stats_.wins;
+    } else if (tr.pnl_bp < 0.0) {
+        ++stats_.losses;
+    }
+    ++stats_.closes;
+    open_ = false;
+    open_dir_ = 0;
+}
+
+void Backtester::take_fills() {
+    for (const SimFill& f : fill_->fills()) {
+        if (f.entry) {
+            open_ = true;
+            open_dir_ = f.dir;
+            open_ts_ = f.ts;
+            open_price_ = f.price;
+            open_fee_bp_ = f.fee_bp;
+            ++stats_.opens;
+        } else {
+            close_trade(f.ts, f.price, f.fee_bp);
+        }
+    }
+    fill_->clear_fills();
+}
+
+void Backtester::step(const Tick& tick) {
+    step(tick, book_);
+}
+
+void Backtester::step(const Tick& tick, const L2Book& book) {
+    ++stats_.ticks;
+    if (fill_) {
+        fill_->advance_to(tick.timestamp, book);
+        fill_->on_trade(tick.timestamp, tick.price, tick.volume, tick.side);
+    }
+    detector_->process_tick(tick);
+    for (const SweepEventMeta& ev : detector_->tick_events()) {
+        ++stats_.sweeps;
+        handle_action(strategy_.on_sweep(ev));
+    }
+    handle_action(strategy_.on_tick(tick.timestamp, tick.price));
+    if (fill_) take_fills();
+}
+
+void Backtester::fill_advance_to(double ts, const L2Book& book) {
+    fill_->advance_to(ts, book);
+    take_fills();
+}
+
+void Backtester::fill_on_book(double ts, const L2Book& book) {
+    fill_->on_book(ts, book);
+    take_fills();
+}
+
+void Backtester::run(const double* ts,
+                     const double* price,
+                     const double* volume,
+                     const int8_t* side,
+                     std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        step(Tick{ts[i], price[i], volume[i], side[i] > 0 ? Side::Buy : Side::Sell});
+    }
+}
+
+void Backtester::check_order(double ts) {
+    if (started_ && ts < last_ts_) {
+        throw std::invalid_argument("Backtester: input streams must be sorted by ts");
+    }
+    last_ts_ = ts;
+    started_ = true;
+}
+
+void Backtester::run(const double* trade_ts, const double* trade_price,
+                     const double* trade_volume, const int8_t* trade_side, std::size_t n_trades,
+                     const double* book_ts, const double* book_price, const double* book_size,
+                     const int8_t* book_side, const uint8_t* book_flags, std::size_t n_book) {
+    if (!fill_) throw std::invalid_argument("Backtester: book replay needs a FillModel");
+    merge_trade_book(
+        trade_ts, n_trades, book_ts, book_price, book_size, book_side, book_flags, n_book,
+        bids_, asks_,
+        [&](std::size_t i) {
+            check_order(trade_ts[i]);
+            step(Tick{trade_ts[i], trade_price[i], trade_volume[i],
+                      trade_side[i] > 0 ? Side::Buy : Side::Sell},
+                 book_);
+        },
+        [&](double ts, bool snapshot, std::size_t) {
+            check_order(ts);
+            advance_to(ts, book_);
+            if (snapshot) book_.clear();
+            book_.apply_bids(bids_.data(), bids_.size() / 2);
+            book_.apply_asks(asks_.data(), asks_.size() / 2);
+            on_book(ts, book_);
+        });
+}
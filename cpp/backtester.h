@@ -0,0 +1,106 @@
+// cpp/backtester.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sweep_model.h"
+#include "mean_reversion_strategy.h"
+#include "fill_simulator.h"
+#include "l2_book.h"
+
+// 单笔成交记录（开仓 -> 平仓）
+struct TradeRecord {
+    double entry_ts;
+    double exit_ts;
+    double entry_price;
+    double exit_price;
+    double pnl_bp;       // 按方向计算的收益（bp）；有成交模拟时已扣两边手续费
+    int    dir;          // 1=long, -1=short
+};
+
+struct BacktestStats {
+    int64_t ticks = 0;
+    int64_t sweeps = 0;
+    int64_t opens = 0;
+    int64_t closes = 0;
+    int64_t wins = 0;
+    int64_t losses = 0;
+    double  cum_pnl_bp = 0.0;
+};
+
+// === 离线回测：sweep 检测器 + MeanReversionStrategy 全部在 C++ 内回放 ===
+// 默认按策略给出的价格理想成交；带 FillModel 时策略动作交给 FillSimulator，
+// 账本按模拟成交记（opens / closes 为实际成交的开平仓，pnl 扣手续费），策略自身的决策不变
+class Backtester {
+public:
+    // 检测器（clone）/ 策略按值拷贝，回测不影响调用方持有的实例
+    explicit Backtester(const SweepDetector& detector = SweepModel(),
+                        const MeanReversionStrategy& strategy = MeanReversionStrategy());
+    Backtester(const SweepDetector& detector, const MeanReversionStrategy& strategy,
+               const FillModel& fill);
+
+    // 喂一条 tick：先做 sweep 检测，本 tick 确认的每个事件依次 on_sweep，再 on_tick 管理持仓
+    // 有成交模拟时用回测自己的盘口（只 run 成交数据时为空）
+    void step(const Tick& tick);
+
+    // 列式批量回放（side: >0=Buy, 否则 Sell），可多次调用续跑
+    void run(const double* ts,
+             const double* price,
+             const double* volume,
+             const int8_t* side,
+             std::size_t n);
+
+    // 成交 + 盘口归并回放（约定同 ReplayEngine::run），盘口喂给成交模拟；需要 FillModel
+    // 可多次调用续跑，段与段之间时间须不减；未排序抛 std::invalid_argument
+    void run(const double* trade_ts, const double* trade_price, const double* trade_volume,
+             const int8_t* trade_side, std::size_t n_trades,
+             const double* book_ts, const double* book_price, const double* book_size,
+             const int8_t* book_side, const uint8_t* book_flags, std::size_t n_book);
+
+    // 外部维护盘口（ParamGrid 里一份盘口服务一批回测）：
+    // 盘口消息应用前 advance_to(ts, book)，应用后 on_book(ts, book)；成交用 step(tick, book)
+    // 没有在途订单 / 挂单时 advance_to / on_book 直接返回（一份盘口驱动一批回测时的常态）
+    void step(const Tick& tick, const L2Book& book);
+    void advance_to(double ts, const L2Book& book) {
+        if (fill_ && !fill_->idle()) fill_advance_to(ts, book);
+    }
+    void on_book(double ts, const L2Book& book) {
+        if (fill_ && !fill_->idle()) fill_on_book(ts, book);
+    }
+
+    const std::vector<TradeRecord>& trades() const { return trades_; }
+    const BacktestStats& stats() const { return stats_; }
+    const SweepDetector& detector() const { return *detector_; }
+    // 没有成交模拟时为 nullptr
+    const FillSimulator* fill() const { return fill_.get(); }
+    const L2Book& book() const { return book_; }
+
+private:
+    std::unique_ptr<SweepDetector> detector_;
+    MeanReversionStrategy strategy_;
+    std::unique_ptr<FillSimulator> fill_;
+    L2Book book_;
+    std::vector<double> bids_;  // 盘口消息的 N×2 (price, size)，复用
+    std::vector<double> asks_;
+    bool   started_ = false;
+    double last_ts_ = 0.0;
+
+    std::vector<TradeRecord> trades_;
+    BacktestStats stats_;
+
+    // 当前未平仓的开仓信息
+    bool   open_ = false;
+    int    open_dir_ = 0;
+    double open_ts_ = 0.0;
+    double open_price_ = 0.0;
+    double open_fee_bp_ = 0.0;
+
+    void handle_action(const StrategyAction& act);
+    void close_trade(double ts, double price, double fee_bp);
+    void take_fills();
+    void fill_advance_to(double ts, const L2Book& book);
+    void fill_on_book(double ts, const L2Book& book);
+    void check_order(double ts);
+};
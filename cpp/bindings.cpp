@@ -1,14 +1,305 @@
 // cpp/bindings.cpp
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "sweep_model.h"
+#include "price_move_detector.h"
 #include "mean_reversion_strategy.h"
+#include "strategy_bank.h"
 #include "orderflow_features.h"
+#include "replay_engine.h"
+#include "l2_book.h"
+#include "backtester.h"
+#include "fill_simulator.h"
+#include "param_grid.h"
+#include "fast_parse.h"
+#include "bybit_feed.h"
+#include "symbol_engine.h"
+#include "tick_store.h"
+#include "event_journal.h"
+#include "tick_csv.h"
+#include "event_returns.h"
+#include "volume_windows.h"
+#include "latency.h"
 
 namespace py = pybind11;
 
+// 连续内存的一维数组；dtype 一致时不拷贝
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using Int8Array   = py::array_t<int8_t, py::array::c_style | py::array::forcecast>;
+using UInt8Array  = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
+namespace {
+
+py::ssize_t column_length(const py::array& a, const char* name) {
+    if (a.ndim() != 1) {
+        throw py::value_error(std::string(name) + " must be a 1-D array");
+    }
+    return a.shape(0);
+}
+
+// ts/price/volume/side 四列必须等长
+py::ssize_t tick_columns_length(const py::array& ts, const py::array& price,
+                                const py::array& volume, const py::array& side) {
+    py::ssize_t n = column_length(ts, "ts");
+    if (column_length(price, "price") != n ||
+        column_length(volume, "volume") != n ||
+        column_length(side, "side") != n) {
+        throw py::value_error("ts/price/volume/side must have the same length");
+    }
+    return n;
+}
+
+// 盘口行的 flags 列：可为 None（返回空数组，数据指针按 nullptr 传），否则须与盘口列等长
+UInt8Array load_book_flags(py::object book_flags, py::ssize_t n) {
+    UInt8Array flags;
+    if (book_flags.is_none()) return flags;
+    flags = book_flags.cast<UInt8Array>();
+    if (column_length(flags, "book_flags") != n) {
+        throw py::value_error("book_flags must match the book columns");
+    }
+    return flags;
+}
+
+// L2 档位输入：N×2 float64 数组直接取指针（不拷贝），
+// 或 Bybit 原始的 [["price","size"], ...] 序列，字符串在 C++ 里解析到复用的 scratch
+struct LevelsView {
+    DoubleArray array;  // 数组输入时持有引用
+    const double* data = nullptr;
+    std::size_t n = 0;
+};
+
+double level_value(py::handle h) {
+    if (PyUnicode_Check(h.ptr())) {
+        Py_ssize_t len = 0;
+        const char* s = PyUnicode_AsUTF8AndSize(h.ptr(), &len);
+        if (!s) throw py::error_already_set();
+        double v = 0.0;
+        if (!parse_double(s, static_cast<std::size_t>(len), v)) {
+            throw py::value_error("invalid number in book level: " + std::string(s, len));
+        }
+        return v;
+    }
+    return h.cast<double>();
+}
+
+LevelsView load_levels(py::handle obj, const char* name, std::vector<double>& scratch) {
+    LevelsView view;
+    if (py::isinstance<py::array>(obj)) {
+        view.array = DoubleArray::ensure(obj);
+        if (!view.array) throw py::error_already_set();
+        if (view.array.ndim() != 2 || view.array.shape(1) != 2) {
+            throw py::value_error(std::string(name) + " must be an N x 2 array");
+        }
+        view.data = view.array.data();
+        view.n = static_cast<std::size_t>(view.array.shape(0));
+        return view;
+    }
+    if (!py::isinstance<py::sequence>(obj)) {
+        throw py::type_error(std::string(name) + " must be an N x 2 array or a sequence of pairs");
+    }
+    auto seq = py::reinterpret_borrow<py::sequence>(obj);
+    scratch.clear();
+    for (py::handle row : seq) {
+        if (!py::isinstance<py::sequence>(row) || py::len(row) != 2) {
+            throw py::value_error(std::string(name) + " rows must be (price, size) pairs");
+        }
+        auto pair = py::reinterpret_borrow<py::sequence>(row);
+        scratch.push_back(level_value(pair[0]));
+        scratch.push_back(level_value(pair[1]));
+    }
+    view.data = scratch.data();
+    view.n = scratch.size() / 2;
+    return view;
+}
+
+// 把 bids / asks 交给 fn(bid_ptr, n_bid, ask_ptr, n_ask)
+template <typename Fn>
+void with_levels(py::handle bids, py::handle asks, Fn&& fn) {
+    thread_local std::vector<double> bid_scratch;
+    thread_local std::vector<double> ask_scratch;
+    LevelsView b = load_levels(bids, "bids", bid_scratch);
+    LevelsView a = load_levels(asks, "asks", ask_scratch);
+    fn(b.data, b.n, a.data, a.n);
+}
+
+template <typename T>
+py::array_t<T> to_numpy(const std::vector<T>& v) {
+    py::array_t<T> out(static_cast<py::ssize_t>(v.size()));
+    if (!v.empty()) {
+        std::memcpy(out.mutable_data(), v.data(), v.size() * sizeof(T));
+    }
+    return out;
+}
+
+// 接管 vector 的内存，不拷贝
+template <typename T>
+py::array_t<T> move_to_numpy(std::vector<T>&& v) {
+    auto* holder = new std::vector<T>(std::move(v));
+    py::capsule owner(holder, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+    return py::array_t<T>({static_cast<py::ssize_t>(holder->size())},
+                          {static_cast<py::ssize_t>(sizeof(T))},
+                          holder->data(), owner);
+}
+
+// 指向 owner 内存的只读 NumPy 视图（owner 存活期间有效）
+template <typename T>
+py::array_t<T> readonly_view(const T* data, std::size_t n, py::handle owner) {
+    py::array_t<T> arr({static_cast<py::ssize_t>(n)}, {static_cast<py::ssize_t>(sizeof(T))},
+                       data, owner);
+    arr.attr("setflags")(py::arg("write") = false);
+    return arr;
+}
+
+// WebSocket 消息：str / bytes 原文，不拷贝（指针在 message 存活期间有效）
+std::string_view message_view(py::handle message) {
+    Py_ssize_t len = 0;
+    if (PyBytes_Check(message.ptr())) {
+        char* buf = nullptr;
+        if (PyBytes_AsStringAndSize(message.ptr(), &buf, &len) != 0) {
+            throw py::error_already_set();
+        }
+        return std::string_view(buf, static_cast<std::size_t>(len));
+    }
+    if (PyUnicode_Check(message.ptr())) {
+        const char* s = PyUnicode_AsUTF8AndSize(message.ptr(), &len);
+        if (!s) throw py::error_already_set();
+        return std::string_view(s, static_cast<std::size_t>(len));
+    }
+    throw py::type_error("message must be str or bytes");
+}
+
+// 列式帧 -> {字段名: NumPy 数组}（拷贝）；uint8 列是 bool 标记，导出为 numpy bool
+template <typename T>
+py::array column_to_numpy(const std::vector<T>& v) {
+    return to_numpy(v);
+}
+
+py::array column_to_numpy(const std::vector<uint8_t>& v) {
+    py::array_t<bool> out(static_cast<py::ssize_t>(v.size()));
+    if (!v.empty()) std::memcpy(out.mutable_data(), v.data(), v.size());
+    return out;
+}
+
+py::dict frame_columns_to_dict(const OrderFlowFrameColumns& c) {
+    py::dict out;
+#define FRAME_COLUMN_TO_NUMPY(T, name) out[#name] = column_to_numpy(c.name);
+    ORDERFLOW_FRAME_COLUMNS(FRAME_COLUMN_TO_NUMPY)
+#undef FRAME_COLUMN_TO_NUMPY
+    return out;
+}
+
+// 同上，但接管各列内存（不拷贝），c 被清空
+template <typename T>
+py::array take_column(std::vector<T>&& v) {
+    return move_to_numpy(std::move(v));
+}
+
+py::array take_column(std::vector<uint8_t>&& v) {
+    py::object arr = move_to_numpy(std::move(v)).attr("view")(py::dtype::of<bool>());
+    return py::reinterpret_steal<py::array>(arr.release());
+}
+
+py::dict take_frame_columns(OrderFlowFrameColumns& c) {
+    py::dict out;
+#define FRAME_COLUMN_TAKE(T, name) out[#name] = take_column(std::move(c.name));
+    ORDERFLOW_FRAME_COLUMNS(FRAME_COLUMN_TAKE)
+#undef FRAME_COLUMN_TAKE
+    c.clear();
+    return out;
+}
+
+// 调度帧：列之外再带一列 trigger（FrameTrigger 的值），取走后两边都清空
+py::dict take_scheduled_frames(OrderFlowFrameColumns& c, std::vector<uint8_t>& triggers) {
+    py::dict out = take_frame_columns(c);
+    out["trigger"] = move_to_numpy(std::move(triggers));
+    triggers.clear();
+    return out;
+}
+
+// OrderFlowFrameRecord 的结构化 dtype（显式 offsets / itemsize，与 C++ 布局逐字节一致）
+template <typename T>
+py::dtype column_dtype() {
+    return py::dtype::of<T>();
+}
+
+template <>
+py::dtype column_dtype<uint8_t>() {
+    return py::dtype::of<bool>();
+}
+
+py::dtype frame_record_dtype() {
+    py::list names, formats, offsets;
+#define FRAME_RECORD_FIELD(T, name)                            \
+    names.append(#name);                                       \
+    formats.append(column_dtype<T>());                         \
+    offsets.append(offsetof(OrderFlowFrameRecord, name));
+    ORDERFLOW_FRAME_COLUMNS(FRAME_RECORD_FIELD)
+#undef FRAME_RECORD_FIELD
+    py::dict spec;
+    spec["names"] = names;
+    spec["formats"] = formats;
+    spec["offsets"] = offsets;
+    spec["itemsize"] = sizeof(OrderFlowFrameRecord);
+    return py::dtype::from_args(spec);
+}
+
+py::array frame_columns_to_records(const OrderFlowFrameColumns& c) {
+    py::array out(frame_record_dtype(), {static_cast<py::ssize_t>(c.size())});
+    auto* rec = static_cast<OrderFlowFrameRecord*>(out.mutable_data());
+    {
+        py::gil_scoped_release release;
+        c.to_records(rec);
+    }
+    return out;
+}
+
+py::object export_frames(const OrderFlowFrameColumns& c, bool as_records) {
+    if (as_records) return frame_columns_to_records(c);
+    return frame_columns_to_dict(c);
+}
+
+// 状态快照：serialize() -> bytes，T.deserialize(bytes)，并支持 pickle / copy.deepcopy
+template <typename Class>
+void def_snapshot(Class cls) {
+    using T = typename Class::type;
+    cls.def("serialize", [](const T& self) { return py::bytes(self.serialize()); })
+        .def_static("deserialize",
+                    [](const py::bytes& data) { return T::deserialize(std::string(data)); },
+                    py::arg("data"))
+        .def(py::pickle(
+            [](const T& self) { return py::bytes(self.serialize()); },
+            [](const py::bytes& data) { return T::deserialize(std::string(data)); }));
+}
+
+}  // namespace
+
 PYBIND11_MODULE(sweep_core, m) {
+    // NumPy 结构化 dtype（批量接口返回）
+    PYBIND11_NUMPY_DTYPE(SweepEventMeta,
+                         ts_start, ts_end, price_start, price_end, volume_total, direction);
+    PYBIND11_NUMPY_DTYPE(TradeRecord,
+                         entry_ts, exit_ts, entry_price, exit_price, pnl_bp, dir);
+    PYBIND11_NUMPY_DTYPE(TickChunk, first_row, rows, ts_first, ts_last);
+    PYBIND11_NUMPY_DTYPE(GridResult,
+                         short_window_sec, long_window_sec, threshold_ratio,
+                         delay_ms, hold_sec, tp_bp, sl_bp,
+                         detector, window_sec, price_bp, vol_min,
+                         sweeps, opens, closes, wins, losses, cum_pnl_bp,
+                         missed_entries, slippage_bp, fees_bp);
+    PYBIND11_NUMPY_DTYPE(BankAction, ts, price, pnl_bp, index, type, dir);
+    PYBIND11_NUMPY_DTYPE(BankStats, opens, closes, wins, losses, cum_pnl_bp);
+    PYBIND11_NUMPY_DTYPE(JournalRecord,
+                         seq, local_ns, exchange_ts, symbol, kind, action, dir, pad,
+                         price, ts_start, price_start, volume);
+
     // --- 基础枚举 ---
 
     py::enum_<Side>(m, "Side")
@@ -20,6 +311,11 @@ PYBIND11_MODULE(sweep_core, m) {
         .value("UpSweep",  SweepSignal::UpSweep)
         .value("DownSweep",SweepSignal::DownSweep);
 
+    py::enum_<SweepBaseline>(m, "SweepBaseline")
+        .value("Window", SweepBaseline::Window)
+        .value("Ewma",   SweepBaseline::Ewma)
+        .value("EwmaZ",  SweepBaseline::EwmaZ);
+
     // --- Tick 结构 ---
 
     py::class_<Tick>(m, "Tick")
@@ -39,15 +335,62 @@ PYBIND11_MODULE(sweep_core, m) {
         .def_readonly("price_end",   &SweepEventMeta::price_end)
         .def_readonly("volume_total",&SweepEventMeta::volume_total);
 
-    // --- SweepModel 本体 ---
+    // --- sweep 检测器：公共接口 + 两种实现 ---
 
-    py::class_<SweepModel>(m, "SweepModel")
-        .def(py::init<double,double,double>(),
+    py::class_<SweepDetector>(m, "SweepDetector")
+        .def("process_tick", &SweepDetector::process_tick)
+        .def("flush", &SweepDetector::flush)
+        // 最近一次 process_tick / flush 确认的全部事件
+        .def("tick_events", [](const SweepDetector& self) { return to_numpy(self.tick_events()); })
+        // 批量接口：返回 (每条 tick 的信号 int8 数组, SweepEventMeta 结构化数组)
+        // flush=True 时末尾再结算未结束的窗口，这部分事件只出现在事件数组里
+        .def("process_ticks",
+             [](SweepDetector& self, DoubleArray ts, DoubleArray price,
+                DoubleArray volume, Int8Array side, bool flush) {
+                 py::ssize_t n = tick_columns_length(ts, price, volume, side);
+                 Int8Array signals(n);
+                 int8_t* sig_out = signals.mutable_data();
+                 std::vector<SweepEventMeta> events;
+                 {
+                     py::gil_scoped_release release;
+                     self.process_ticks(ts.data(), price.data(), volume.data(), side.data(),
+                                        static_cast<std::size_t>(n), sig_out, &events);
+                     if (flush) {
+                         self.flush();
+                         events.insert(events.end(), self.tick_events().begin(),
+                                       self.tick_events().end());
+                     }
+                 }
+                 return py::make_tuple(signals, to_numpy(events));
+             },
+             py::arg("ts"), py::arg("price"), py::arg("volume"), py::arg("side"),
+             py::arg("flush") = false)
+        .def("get_last_event", &SweepDetector::get_last_event);
+
+    // baseline=Ewma / EwmaZ 时 long_window_sec 为 EWMA 时间常数，EwmaZ 的 threshold_ratio 为 z 阈值
+    def_snapshot(py::class_<SweepModel, SweepDetector>(m, "SweepModel")
+        .def(py::init<double,double,double,SweepBaseline>(),
              py::arg("short_window_sec") = 0.3,
              py::arg("long_window_sec")  = 10.0,
-             py::arg("threshold_ratio")  = 3.0)
-        .def("process_tick", &SweepModel::process_tick)
-        .def("get_last_event", &SweepModel::get_last_event);
+             py::arg("threshold_ratio")  = 3.0,
+             py::arg("baseline")         = SweepBaseline::Window)
+        .def_property_readonly("short_window_sec",
+                               [](const SweepModel& self) { return self.policy().short_window_sec(); })
+        .def_property_readonly("long_window_sec",
+                               [](const SweepModel& self) { return self.policy().long_window_sec(); })
+        .def_property_readonly("threshold_ratio",
+                               [](const SweepModel& self) { return self.policy().threshold_ratio(); })
+        .def_property_readonly("baseline",
+                               [](const SweepModel& self) { return self.policy().baseline(); }));
+
+    py::class_<PriceMoveDetector, SweepDetector>(m, "PriceMoveDetector")
+        .def(py::init<double,double,double>(),
+             py::arg("window_sec") = 0.3,
+             py::arg("price_bp")   = 5.0,
+             py::arg("vol_min")    = 5.0)
+        .def_property_readonly("window_sec", &PriceMoveDetector::window_sec)
+        .def_property_readonly("price_bp", &PriceMoveDetector::price_bp)
+        .def_property_readonly("vol_min", &PriceMoveDetector::vol_min);
 
     // --- 策略动作枚举 & 结构 ---
 
@@ -66,14 +409,233 @@ PYBIND11_MODULE(sweep_core, m) {
 
     // --- 反 sweep 均值回归策略 ---
 
-    py::class_<MeanReversionStrategy>(m, "MeanReversionStrategy")
+    def_snapshot(py::class_<MeanReversionStrategy>(m, "MeanReversionStrategy")
         .def(py::init<double,double,double,double>(),
              py::arg("delay_ms") = 80.0,
              py::arg("hold_sec") = 5.0,
              py::arg("tp_bp")    = 2.0,
              py::arg("sl_bp")    = 2.0)
         .def("on_sweep", &MeanReversionStrategy::on_sweep)
-        .def("on_tick",  &MeanReversionStrategy::on_tick);
+        .def("on_tick",  &MeanReversionStrategy::on_tick));
+
+    // --- 多组策略参数影子运行 ---
+    // on_sweep / on_tick 返回 BankAction 结构化数组（只含产生动作的策略，index 为下标）
+    // stats() 返回 BankStats 结构化数组，行序与添加顺序一致
+
+    def_snapshot(py::class_<StrategyBank>(m, "StrategyBank")
+        .def(py::init<>())
+        .def("add", &StrategyBank::add, py::arg("strategy"))
+        .def("add_product", &StrategyBank::add_product,
+             py::arg("delays_ms"), py::arg("holds_sec"), py::arg("tps_bp"), py::arg("sls_bp"))
+        .def("__len__", &StrategyBank::size)
+        .def("strategy", &StrategyBank::strategy, py::arg("index"))
+        .def("on_sweep",
+             [](StrategyBank& self, const SweepEventMeta& ev) { return to_numpy(self.on_sweep(ev)); },
+             py::arg("ev"))
+        .def("on_tick",
+             [](StrategyBank& self, double ts, double price) {
+                 return to_numpy(self.on_tick(ts, price));
+             },
+             py::arg("ts"), py::arg("price"))
+        .def("stats", [](const StrategyBank& self) { return to_numpy(self.stats()); })
+        .def_property_readonly("open_positions", &StrategyBank::open_positions));
+
+    // --- 离线回测（C++ 内完成整段回放） ---
+
+    py::class_<BacktestStats>(m, "BacktestStats")
+        .def_readonly("ticks",      &BacktestStats::ticks)
+        .def_readonly("sweeps",     &BacktestStats::sweeps)
+        .def_readonly("opens",      &BacktestStats::opens)
+        .def_readonly("closes",     &BacktestStats::closes)
+        .def_readonly("wins",       &BacktestStats::wins)
+        .def_readonly("losses",     &BacktestStats::losses)
+        .def_readonly("cum_pnl_bp", &BacktestStats::cum_pnl_bp);
+
+    // --- 成交模拟（延迟 / 滑点 / 排队 / 手续费） ---
+
+    py::enum_<OrderStyle>(m, "OrderStyle")
+        .value("Market", OrderStyle::Market)
+        .value("Limit",  OrderStyle::Limit);
+
+    py::enum_<LatencyDist>(m, "LatencyDist")
+        .value("Fixed",       LatencyDist::Fixed)
+        .value("Uniform",     LatencyDist::Uniform)
+        .value("Exponential", LatencyDist::Exponential)
+        .value("Empirical",   LatencyDist::Empirical);
+
+    py::class_<FillModel>(m, "FillModel")
+        .def(py::init([](double order_qty, OrderStyle entry, OrderStyle exit,
+                         double limit_timeout_sec, LatencyDist latency, double latency_ms,
+                         double jitter_ms, std::vector<double> latency_samples_ms, uint64_t seed,
+                         double taker_fee_bp, double maker_fee_bp, double tick_size) {
+                 FillModel f;
+                 f.order_qty = order_qty;
+                 f.entry = entry;
+                 f.exit = exit;
+                 f.limit_timeout_sec = limit_timeout_sec;
+                 f.latency = latency;
+                 f.latency_ms = latency_ms;
+                 f.jitter_ms = jitter_ms;
+                 f.latency_samples_ms = std::move(latency_samples_ms);
+                 f.seed = seed;
+                 f.taker_fee_bp = taker_fee_bp;
+                 f.maker_fee_bp = maker_fee_bp;
+                 f.tick_size = tick_size;
+                 return f;
+             }),
+             py::arg("order_qty") = 1.0,
+             py::arg("entry") = OrderStyle::Market,
+             py::arg("exit") = OrderStyle::Market,
+             py::arg("limit_timeout_sec") = 1.0,
+             py::arg("latency") = LatencyDist::Fixed,
+             py::arg("latency_ms") = 0.0,
+             py::arg("jitter_ms") = 0.0,
+             py::arg("latency_samples_ms") = std::vector<double>(),
+             py::arg("seed") = 1,
+             py::arg("taker_fee_bp") = 0.0,
+             py::arg("maker_fee_bp") = 0.0,
+             py::arg("tick_size") = 0.01)
+        .def_readwrite("order_qty",          &FillModel::order_qty)
+        .def_readwrite("entry",              &FillModel::entry)
+        .def_readwrite("exit",               &FillModel::exit)
+        .def_readwrite("limit_timeout_sec",  &FillModel::limit_timeout_sec)
+        .def_readwrite("latency",            &FillModel::latency)
+        .def_readwrite("latency_ms",         &FillModel::latency_ms)
+        .def_readwrite("jitter_ms",          &FillModel::jitter_ms)
+        .def_readwrite("latency_samples_ms", &FillModel::latency_samples_ms)
+        .def_readwrite("seed",               &FillModel::seed)
+        .def_readwrite("taker_fee_bp",       &FillModel::taker_fee_bp)
+        .def_readwrite("maker_fee_bp",       &FillModel::maker_fee_bp)
+        .def_readwrite("tick_size",          &FillModel::tick_size);
+
+    py::class_<FillStats>(m, "FillStats")
+        .def_readonly("orders",          &FillStats::orders)
+        .def_readonly("market_fills",    &FillStats::market_fills)
+        .def_readonly("limit_fills",     &FillStats::limit_fills)
+        .def_readonly("missed_entries",  &FillStats::missed_entries)
+        .def_readonly("limit_to_market", &FillStats::limit_to_market)
+        .def_readonly("slippage_bp",     &FillStats::slippage_bp)
+        .def_readonly("fees_bp",         &FillStats::fees_bp)
+        .def_readonly("latency_ms",      &FillStats::latency_ms);
+
+    py::class_<Backtester>(m, "Backtester")
+        // model 可以是任意 SweepDetector（SweepModel / PriceMoveDetector）
+        .def(py::init<const SweepDetector&, const MeanReversionStrategy&>(),
+             py::arg("model") = SweepModel(),
+             py::arg("strategy") = MeanReversionStrategy())
+        // 带成交模拟：账本按模拟成交价记、扣手续费
+        .def(py::init<const SweepDetector&, const MeanReversionStrategy&, const FillModel&>(),
+             py::arg("model"), py::arg("strategy"), py::arg("fill"))
+        .def("step", py::overload_cast<const Tick&>(&Backtester::step), py::arg("tick"))
+        .def("run",
+             [](Backtester& self, DoubleArray ts, DoubleArray price,
+                DoubleArray volume, Int8Array side) {
+                 py::ssize_t n = tick_columns_length(ts, price, volume, side);
+                 py::gil_scoped_release release;
+                 self.run(ts.data(), price.data(), volume.data(), side.data(),
+                          static_cast<std::size_t>(n));
+             },
+             py::arg("ts"), py::arg("price"), py::arg("volume"), py::arg("side"))
+        // 成交 + 盘口回放（列约定同 ReplayEngine.run），盘口用于成交模拟；需要 fill
+        .def("run_with_book",
+             [](Backtester& self,
+                DoubleArray trade_ts, DoubleArray trade_price, DoubleArray trade_volume,
+                Int8Array trade_side,
+                DoubleArray book_ts, DoubleArray book_price, DoubleArray book_size,
+                Int8Array book_side, py::object book_flags) {
+                 py::ssize_t nt = tick_columns_length(trade_ts, trade_price, trade_volume,
+                                                      trade_side);
+                 py::ssize_t nb = tick_columns_length(book_ts, book_price, book_size, book_side);
+                 UInt8Array flags = load_book_flags(book_flags, nb);
+                 const uint8_t* fp = book_flags.is_none() ? nullptr : flags.data();
+                 py::gil_scoped_release release;
+                 self.run(trade_ts.data(), trade_price.data(), trade_volume.data(),
+                          trade_side.data(), static_cast<std::size_t>(nt),
+                          book_ts.data(), book_price.data(), book_size.data(),
+                          book_side.data(), fp, static_cast<std::size_t>(nb));
+             },
+             py::arg("trade_ts"), py::arg("trade_price"), py::arg("trade_volume"),
+             py::arg("trade_side"), py::arg("book_ts"), py::arg("book_price"),
+             py::arg("book_size"), py::arg("book_side"), py::arg("book_flags") = py::none())
+        // 成交账本：TradeRecord 结构化数组
+        .def("trades", [](const Backtester& self) { return to_numpy(self.trades()); })
+        .def_property_readonly("stats", &Backtester::stats)
+        // 没有成交模拟时为 None
+        .def_property_readonly("fill_stats", [](const Backtester& self) -> py::object {
+            if (!self.fill()) return py::none();
+            return py::cast(self.fill()->stats());
+        });
+
+    // --- 参数网格（多线程） ---
+
+    py::class_<ParamGrid>(m, "ParamGrid")
+        .def(py::init<>())
+        .def("add",
+             [](ParamGrid& self, double short_window_sec, double long_window_sec,
+                double threshold_ratio, double delay_ms, double hold_sec,
+                double tp_bp, double sl_bp, SweepBaseline baseline) {
+                 self.add_product({short_window_sec}, {long_window_sec}, {threshold_ratio},
+                                  {delay_ms}, {hold_sec}, {tp_bp}, {sl_bp}, baseline);
+             },
+             py::arg("short_window_sec"), py::arg("long_window_sec"),
+             py::arg("threshold_ratio"), py::arg("delay_ms"), py::arg("hold_sec"),
+             py::arg("tp_bp"), py::arg("sl_bp"), py::arg("baseline") = SweepBaseline::Window)
+        .def("add_product", &ParamGrid::add_product,
+             py::arg("short_windows"), py::arg("long_windows"), py::arg("thresholds"),
+             py::arg("delays_ms"), py::arg("holds_sec"), py::arg("tps_bp"), py::arg("sls_bp"),
+             py::arg("baseline") = SweepBaseline::Window)
+        .def("add_price_move_product", &ParamGrid::add_price_move_product,
+             py::arg("windows_sec"), py::arg("prices_bp"), py::arg("vol_mins"),
+             py::arg("delays_ms"), py::arg("holds_sec"), py::arg("tps_bp"), py::arg("sls_bp"))
+        .def("__len__", &ParamGrid::size)
+        .def("set_fill_model", &ParamGrid::set_fill_model, py::arg("fill"))
+        .def("clear_fill_model", &ParamGrid::clear_fill_model)
+        .def_property_readonly("fill_model", [](const ParamGrid& self) -> py::object {
+            if (!self.has_fill_model()) return py::none();
+            return py::cast(self.fill_model());
+        })
+        // 返回 GridResult 结构化数组，行序与添加顺序一致
+        .def("run",
+             [](const ParamGrid& self, DoubleArray ts, DoubleArray price,
+                DoubleArray volume, Int8Array side, unsigned num_threads) {
+                 py::ssize_t n = tick_columns_length(ts, price, volume, side);
+                 std::vector<GridResult> results;
+                 {
+                     py::gil_scoped_release release;
+                     results = self.run(ts.data(), price.data(), volume.data(), side.data(),
+                                        static_cast<std::size_t>(n), num_threads);
+                 }
+                 return to_numpy(results);
+             },
+             py::arg("ts"), py::arg("price"), py::arg("volume"), py::arg("side"),
+             py::arg("num_threads") = 0)
+        // 成交 + 盘口（列约定同 ReplayEngine.run），需要先 set_fill_model
+        .def("run_with_book",
+             [](const ParamGrid& self,
+                DoubleArray trade_ts, DoubleArray trade_price, DoubleArray trade_volume,
+                Int8Array trade_side,
+                DoubleArray book_ts, DoubleArray book_price, DoubleArray book_size,
+                Int8Array book_side, py::object book_flags, unsigned num_threads) {
+                 py::ssize_t nt = tick_columns_length(trade_ts, trade_price, trade_volume,
+                                                      trade_side);
+                 py::ssize_t nb = tick_columns_length(book_ts, book_price, book_size, book_side);
+                 UInt8Array flags = load_book_flags(book_flags, nb);
+                 const uint8_t* fp = book_flags.is_none() ? nullptr : flags.data();
+                 std::vector<GridResult> results;
+                 {
+                     py::gil_scoped_release release;
+                     results = self.run(trade_ts.data(), trade_price.data(), trade_volume.data(),
+                                        trade_side.data(), static_cast<std::size_t>(nt),
+                                        book_ts.data(), book_price.data(), book_size.data(),
+                                        book_side.data(), fp, static_cast<std::size_t>(nb),
+                                        num_threads);
+                 }
+                 return to_numpy(results);
+             },
+             py::arg("trade_ts"), py::arg("trade_price"), py::arg("trade_volume"),
+             py::arg("trade_side"), py::arg("book_ts"), py::arg("book_price"),
+             py::arg("book_size"), py::arg("book_side"), py::arg("book_flags") = py::none(),
+             py::arg("num_threads") = 0);
 
     // --- Orderflow frame & extractor ---
     py::enum_<AggRunDir>(m, "AggRunDir")
@@ -116,14 +678,553 @@ PYBIND11_MODULE(sweep_core, m) {
         .def_readonly("agg_run_dir", &OrderFlowFrame::agg_run_dir)
         .def_readonly("weak_side_01", &OrderFlowFrame::weak_side_01);
 
-    py::class_<OrderFlowFeatureExtractor>(m, "OrderFlowFeatureExtractor")
-        .def(py::init<>())
+    // --- 扁平 L2 订单簿（可单独使用） ---
+
+    py::class_<L2Book>(m, "L2Book")
+        .def(py::init<double>(), py::arg("tick_size") = 0.01)
+        .def("apply_bid", &L2Book::apply_bid, py::arg("price"), py::arg("size"))
+        .def("apply_ask", &L2Book::apply_ask, py::arg("price"), py::arg("size"))
+        // bids / asks：N×2 float64 数组，或 [[price, size], ...]（数字或 Bybit 字符串）
+        .def("apply_snapshot",
+             [](L2Book& self, py::handle bids, py::handle asks) {
+                 with_levels(bids, asks, [&](const double* b, std::size_t nb,
+                                             const double* a, std::size_t na) {
+                     self.clear();
+                     self.apply_bids(b, nb);
+                     self.apply_asks(a, na);
+                 });
+             },
+             py::arg("bids"), py::arg("asks"))
+        .def("apply_delta",
+             [](L2Book& self, py::handle bids, py::handle asks) {
+                 with_levels(bids, asks, [&](const double* b, std::size_t nb,
+                                             const double* a, std::size_t na) {
+                     self.apply_bids(b, nb);
+                     self.apply_asks(a, na);
+                 });
+             },
+             py::arg("bids"), py::arg("asks"))
+        .def("clear", &L2Book::clear)
+        .def("best_bid", &L2Book::best_bid)
+        .def("best_ask", &L2Book::best_ask)
+        .def("bid_size_at", &L2Book::bid_size_at, py::arg("price"))
+        .def("ask_size_at", &L2Book::ask_size_at, py::arg("price"))
+        .def("bid_levels", &L2Book::bid_levels)
+        .def("ask_levels", &L2Book::ask_levels)
+        .def("depth_within", &L2Book::depth_within, py::arg("mid"), py::arg("pct"))
+        // 多档深度（bp），返回 (bid 深度数组, ask 深度数组)
+        .def("depth_bands",
+             [](const L2Book& self, double mid, DoubleArray bands_bp) {
+                 py::ssize_t n = column_length(bands_bp, "bands_bp");
+                 py::array_t<double> bid(n), ask(n);
+                 self.depth_bands(mid, bands_bp.data(), static_cast<std::size_t>(n),
+                                  bid.mutable_data(), ask.mutable_data());
+                 return py::make_tuple(bid, ask);
+             },
+             py::arg("mid"), py::arg("bands_bp"))
+        .def_property_readonly("tick_size", &L2Book::tick_size)
+        // 坏价格 / 超出单边区间上限而被拒收的档位数
+        .def_property_readonly("rejected_levels", &L2Book::rejected_levels);
+
+    // --- 帧调度 ---
+
+    py::enum_<FrameTrigger>(m, "FrameTrigger")
+        .value("Interval", FrameTrigger::Interval)
+        .value("Trades",   FrameTrigger::Trades)
+        .value("Sweep",    FrameTrigger::Sweep);
+
+    py::class_<FrameSchedule>(m, "FrameSchedule")
+        .def(py::init([](double interval_sec, int64_t every_n_trades, bool on_sweep,
+                         bool skip_unchanged) {
+                 FrameSchedule s;
+                 s.interval_sec = interval_sec;
+                 s.every_n_trades = every_n_trades;
+                 s.on_sweep = on_sweep;
+                 s.skip_unchanged = skip_unchanged;
+                 return s;
+             }),
+             py::arg("interval_sec") = 0.0,
+             py::arg("every_n_trades") = 0,
+             py::arg("on_sweep") = false,
+             py::arg("skip_unchanged") = false)
+        .def_readwrite("interval_sec",   &FrameSchedule::interval_sec)
+        .def_readwrite("every_n_trades", &FrameSchedule::every_n_trades)
+        .def_readwrite("on_sweep",       &FrameSchedule::on_sweep)
+        .def_readwrite("skip_unchanged", &FrameSchedule::skip_unchanged);
+
+    def_snapshot(py::class_<OrderFlowFeatureExtractor>(m, "OrderFlowFeatureExtractor")
+        .def(py::init<double, double, double, double, double>(),
+             py::arg("vol_win_1") = 1.0,
+             py::arg("vol_win_2") = 3.0,
+             py::arg("vol_win_3") = 10.0,
+             py::arg("tick_size") = 0.01,
+             py::arg("extreme_bucket_sec") = 0.05)
         .def("add_trade", &OrderFlowFeatureExtractor::add_trade,
              py::arg("ts"), py::arg("price"), py::arg("volume"), py::arg("side"))
-        .def("apply_l2_snapshot", &OrderFlowFeatureExtractor::apply_l2_snapshot,
+        // bids / asks 同 L2Book.apply_snapshot
+        .def("apply_l2_snapshot",
+             [](OrderFlowFeatureExtractor& self, py::handle bids, py::handle asks) {
+                 with_levels(bids, asks, [&](const double* b, std::size_t nb,
+                                             const double* a, std::size_t na) {
+                     self.apply_l2_snapshot(b, nb, a, na);
+                 });
+             },
              py::arg("bids"), py::arg("asks"))
-        .def("apply_l2_delta", &OrderFlowFeatureExtractor::apply_l2_delta,
+        .def("apply_l2_delta",
+             [](OrderFlowFeatureExtractor& self, py::handle bids, py::handle asks) {
+                 with_levels(bids, asks, [&](const double* b, std::size_t nb,
+                                             const double* a, std::size_t na) {
+                     self.apply_l2_delta(b, nb, a, na);
+                 });
+             },
              py::arg("bids"), py::arg("asks"))
+        // 只读，不影响调度帧；20s / 30s 新高新低与每次成交 / 盘口更新后的 mid 历史比较
         .def("get_frame", &OrderFlowFeatureExtractor::get_frame,
-             py::arg("ts_now") = 0.0);
+             py::arg("ts_now") = 0.0)
+        // 批量取帧，不生成逐帧的 Python 对象；返回格式同 ReplayEngine.frames
+        // ts 早于最后一条成交时 ValueError；不释放 GIL：别的线程此时不能 add_trade / apply_l2_*
+        .def("get_frames",
+             [](const OrderFlowFeatureExtractor& self, DoubleArray ts, bool as_records) -> py::object {
+                 py::ssize_t n = column_length(ts, "ts");
+                 OrderFlowFrameColumns cols;
+                 self.get_frames(ts.data(), static_cast<std::size_t>(n), cols);
+                 if (as_records) return frame_columns_to_records(cols);
+                 return take_frame_columns(cols);
+             },
+             py::arg("ts"), py::arg("as_records") = false)
+        // 调度出帧：set_schedule(FrameSchedule(interval_sec=0.1)) 后随 add_trade 自动产生，
+        // take_scheduled_frames() 取走（列 + trigger）
+        .def("set_schedule", &OrderFlowFeatureExtractor::set_schedule, py::arg("schedule"))
+        .def_property_readonly("schedule", &OrderFlowFeatureExtractor::schedule)
+        .def("advance_to", &OrderFlowFeatureExtractor::advance_to, py::arg("ts"))
+        .def("on_sweep", &OrderFlowFeatureExtractor::on_sweep, py::arg("event"))
+        .def("take_scheduled_frames",
+             [](OrderFlowFeatureExtractor& self) {
+                 return take_scheduled_frames(self.scheduled_frames(), self.scheduled_triggers());
+             })
+        .def_property_readonly("pending_frames",
+             [](const OrderFlowFeatureExtractor& self) { return self.scheduled_frames().size(); })
+        .def_property_readonly("book", &OrderFlowFeatureExtractor::book));
+
+    // --- 成交 + 盘口确定性回放 ---
+    // engine = ReplayEngine(OrderFlowFeatureExtractor(), frame_interval_sec=0.1)
+    //   或 ReplayEngine(extractor, FrameSchedule(interval_sec=0.1, every_n_trades=50))
+    // engine.run(trades_ts, price, volume, side, book_ts, book_price, book_size, book_side, book_flags)
+    // cols = engine.frames()   # {字段名: ndarray}，字段同 OrderFlowFrame
+
+    // 帧记录的结构化 dtype：np.memmap(path, dtype=sweep_core.frame_dtype) 可直接读落盘帧
+    m.attr("frame_dtype") = frame_record_dtype();
+    m.attr("FRAME_RECORD_VERSION") = kFrameRecordVersion;
+
+    py::class_<ReplayStats>(m, "ReplayStats")
+        .def_readonly("trades",        &ReplayStats::trades)
+        .def_readonly("book_rows",     &ReplayStats::book_rows)
+        .def_readonly("book_messages", &ReplayStats::book_messages)
+        .def_readonly("snapshots",     &ReplayStats::snapshots)
+        .def_readonly("frames",        &ReplayStats::frames);
+
+    py::class_<ReplayEngine>(m, "ReplayEngine")
+        .def(py::init<const OrderFlowFeatureExtractor&, double>(),
+             py::arg("extractor") = OrderFlowFeatureExtractor(),
+             py::arg("frame_interval_sec") = 0.1)
+        .def(py::init<const OrderFlowFeatureExtractor&, const FrameSchedule&>(),
+             py::arg("extractor"), py::arg("schedule"))
+        // book_side: +1=Bid, -1=Ask；book_flags 可为 None（全部按 delta）
+        .def("run",
+             [](ReplayEngine& self,
+                DoubleArray trade_ts, DoubleArray trade_price, DoubleArray trade_volume,
+                Int8Array trade_side,
+                DoubleArray book_ts, DoubleArray book_price, DoubleArray book_size,
+                Int8Array book_side, py::object book_flags) {
+                 py::ssize_t nt = tick_columns_length(trade_ts, trade_price, trade_volume,
+                                                      trade_side);
+                 py::ssize_t nb = tick_columns_length(book_ts, book_price, book_size, book_side);
+                 UInt8Array flags = load_book_flags(book_flags, nb);
+                 const uint8_t* fp = book_flags.is_none() ? nullptr : flags.data();
+                 py::gil_scoped_release release;
+                 self.run(trade_ts.data(), trade_price.data(), trade_volume.data(),
+                          trade_side.data(), static_cast<std::size_t>(nt),
+                          book_ts.data(), book_price.data(), book_size.data(),
+                          book_side.data(), fp, static_cast<std::size_t>(nb));
+             },
+             py::arg("trade_ts"), py::arg("trade_price"), py::arg("trade_volume"),
+             py::arg("trade_side"), py::arg("book_ts"), py::arg("book_price"),
+             py::arg("book_size"), py::arg("book_side"), py::arg("book_flags") = py::none())
+        // as_records=False：{字段名: ndarray}（拷贝）；True：frame_dtype 结构化数组
+        .def("frames",
+             [](const ReplayEngine& self, bool as_records) {
+                 return export_frames(self.frames(), as_records);
+             },
+             py::arg("as_records") = false)
+        .def("triggers", [](const ReplayEngine& self) { return to_numpy(self.triggers()); })
+        // 取走已出的帧（列直接交给 NumPy，不拷贝，另带 trigger 列），引擎里的帧缓冲清空，可继续 run
+        .def("take_frames",
+             [](ReplayEngine& self) {
+                 return take_scheduled_frames(self.frames(), self.triggers());
+             })
+        .def_property_readonly("stats", &ReplayEngine::stats)
+        .def_property_readonly("extractor", &ReplayEngine::extractor)
+        .def_property_readonly("schedule", &ReplayEngine::schedule);
+
+    // --- Bybit 行情消息直通 ---
+
+    py::class_<FeedStats>(m, "FeedStats")
+        .def_readonly("messages",     &FeedStats::messages)
+        .def_readonly("trades",       &FeedStats::trades)
+        .def_readonly("book_updates", &FeedStats::book_updates)
+        .def_readonly("sweeps",       &FeedStats::sweeps)
+        .def_readonly("actions",      &FeedStats::actions)
+        .def_readonly("ignored",      &FeedStats::ignored)
+        .def_readonly("parse_errors", &FeedStats::parse_errors)
+        .def_readonly("book_gaps",    &FeedStats::book_gaps)
+        .def_readonly("book_skipped", &FeedStats::book_skipped);
+
+    py::class_<BybitFeedHandler>(m, "BybitFeedHandler")
+        .def(py::init<const std::string&, const SweepModel&, const MeanReversionStrategy&,
+                      const OrderFlowFeatureExtractor&>(),
+             py::arg("symbol"),
+             py::arg("model") = SweepModel(),
+             py::arg("strategy") = MeanReversionStrategy(),
+             py::arg("extractor") = OrderFlowFeatureExtractor())
+        // message: WebSocket 原始 str / bytes；解析和策略计算时释放 GIL
+        // 只有产生非 Idle 动作时才调用 callback(action)，返回动作数
+        .def("on_message",
+             [](BybitFeedHandler& self, py::handle message, py::object callback) {
+                 std::string_view msg = message_view(message);
+                 std::size_t n = 0;
+                 {
+                     py::gil_scoped_release release;
+                     n = self.on_message(msg.data(), msg.size());
+                 }
+                 if (n > 0 && !callback.is_none()) {
+                     for (const StrategyAction& act : self.actions()) callback(act);
+                 }
+                 return n;
+             },
+             py::arg("message"), py::arg("callback") = py::none())
+        // 策略线程：等最多 timeout 秒直到队列有记录，取出处理；callback 同 on_message
+        .def("drain",
+             [](BybitFeedHandler& self, MarketQueue& queue, py::object callback,
+                double timeout, std::size_t max_records) {
+                 std::size_t n = 0;
+                 {
+                     py::gil_scoped_release release;
+                     if (timeout <= 0.0 || queue.wait(timeout)) n = self.drain(queue, max_records);
+                 }
+                 if (n > 0 && !callback.is_none()) {
+                     for (const StrategyAction& act : self.actions()) callback(act);
+                 }
+                 return n;
+             },
+             py::arg("queue"), py::arg("callback") = py::none(), py::arg("timeout") = 0.0,
+             py::arg("max_records") = 0)
+        .def("actions", &BybitFeedHandler::actions)
+        // journal=None 关闭；对象持有 journal 的引用
+        .def("set_journal", &BybitFeedHandler::set_journal,
+             py::arg("journal"), py::arg("symbol_id") = 0, py::keep_alive<1, 2>())
+        .def_property_readonly("stats", &BybitFeedHandler::stats)
+        .def_property_readonly("symbol", &BybitFeedHandler::symbol)
+        // 丢过盘口更新、还没等到新 snapshot（簿已清空），应重新订阅盘口
+        .def_property_readonly("book_stale", &BybitFeedHandler::book_stale)
+        .def_property_readonly("model", &BybitFeedHandler::model,
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("strategy", &BybitFeedHandler::strategy,
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("extractor", &BybitFeedHandler::extractor,
+                               py::return_value_policy::reference_internal);
+
+    // --- 接收线程 -> 策略线程的行情队列 ---
+
+    py::class_<MarketQueue>(m, "MarketQueue")
+        .def(py::init<std::size_t>(), py::arg("capacity") = 65536)
+        .def_property_readonly("depth", &MarketQueue::depth)
+        .def_property_readonly("max_depth", &MarketQueue::max_depth)
+        .def_property_readonly("capacity", &MarketQueue::capacity)
+        .def_property_readonly("pushed", &MarketQueue::pushed)
+        .def_property_readonly("popped", &MarketQueue::popped)
+        .def_property_readonly("dropped", &MarketQueue::dropped)
+        .def_property_readonly("dropped_messages", &MarketQueue::dropped_messages);
+
+    py::class_<BybitRecordDecoder>(m, "BybitRecordDecoder")
+        .def(py::init<const std::string&>(), py::arg("symbol"))
+        // 接收线程：解析 message 并整条入队，返回入队记录数
+        .def("push",
+             [](BybitRecordDecoder& self, py::handle message, MarketQueue& queue) {
+                 std::string_view msg = message_view(message);
+                 py::gil_scoped_release release;
+                 return self.push(msg.data(), msg.size(), queue);
+             },
+             py::arg("message"), py::arg("queue"))
+        .def_property_readonly("stats", &BybitRecordDecoder::stats)
+        .def_property_readonly("symbol", &BybitRecordDecoder::symbol);
+
+    // --- 多 symbol 分片引擎 ---
+
+    py::class_<EngineStats>(m, "EngineStats")
+        .def_readonly("posted",          &EngineStats::posted)
+        .def_readonly("rejected",        &EngineStats::rejected)
+        .def_readonly("unrouted",        &EngineStats::unrouted)
+        .def_readonly("actions",         &EngineStats::actions)
+        .def_readonly("dropped_actions", &EngineStats::dropped_actions)
+        .def_readonly("errors",          &EngineStats::errors);
+
+    py::class_<SymbolEngine>(m, "SymbolEngine")
+        .def(py::init<unsigned, std::vector<int>, std::size_t, std::size_t>(),
+             py::arg("num_workers") = 0,
+             py::arg("cpus") = std::vector<int>(),
+             py::arg("queue_capacity") = 4096,
+             py::arg("output_capacity") = 65536)
+        .def("add_symbol", &SymbolEngine::add_symbol,
+             py::arg("symbol"),
+             py::arg("model") = SweepModel(),
+             py::arg("strategy") = MeanReversionStrategy(),
+             py::arg("extractor") = OrderFlowFeatureExtractor())
+        .def("set_journal", &SymbolEngine::set_journal,
+             py::arg("journal"), py::keep_alive<1, 2>())
+        .def("start", &SymbolEngine::start)
+        .def("stop", &SymbolEngine::stop, py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("running", &SymbolEngine::running)
+        // 接收线程调用：message 为 WebSocket 原始 str / bytes，只做路由和拷贝
+        .def("post",
+             [](SymbolEngine& self, py::handle message) {
+                 std::string_view msg = message_view(message);
+                 return self.post(msg.data(), msg.size());
+             },
+             py::arg("message"))
+        // 取出已产生的动作：[(symbol, StrategyAction), ...]；max_actions=0 表示全部
+        .def("poll",
+             [](SymbolEngine& self, std::size_t max_actions) {
+                 py::list out;
+                 EngineAction ea;
+                 while ((max_actions == 0 || out.size() < max_actions) && self.poll(ea)) {
+                     out.append(py::make_tuple(self.symbol(ea.symbol), ea.action));
+                 }
+                 return out;
+             },
+             py::arg("max_actions") = 0)
+        .def_property_readonly("stats", &SymbolEngine::stats)
+        .def_property_readonly("symbols", [](const SymbolEngine& self) {
+            std::vector<std::string> out;
+            for (uint32_t i = 0; i < self.num_symbols(); ++i) out.push_back(self.symbol(i));
+            return out;
+        })
+        .def_property_readonly("num_workers", &SymbolEngine::num_workers)
+        .def("worker_of", &SymbolEngine::worker_of, py::arg("symbol_id"))
+        .def("queue_depth", &SymbolEngine::queue_depth, py::arg("worker"))
+        .def_property_readonly("output_depth", &SymbolEngine::output_depth);
+
+    // --- 列式二进制 tick 文件（mmap） ---
+
+    py::class_<TickStore>(m, "TickStore")
+        .def(py::init<const std::string&>(), py::arg("path"))
+        .def("__len__", &TickStore::size)
+        // 各列为指向 mmap 的只读数组，可直接传给 process_ticks / Backtester.run / ParamGrid.run
+        .def_property_readonly("ts", [](py::object self) {
+            const TickStore& st = self.cast<const TickStore&>();
+            return readonly_view(st.ts(), st.size(), self);
+        })
+        .def_property_readonly("price", [](py::object self) {
+            const TickStore& st = self.cast<const TickStore&>();
+            return readonly_view(st.price(), st.size(), self);
+        })
+        .def_property_readonly("volume", [](py::object self) {
+            const TickStore& st = self.cast<const TickStore&>();
+            return readonly_view(st.volume(), st.size(), self);
+        })
+        .def_property_readonly("side", [](py::object self) {
+            const TickStore& st = self.cast<const TickStore&>();
+            return readonly_view(st.side(), st.size(), self);
+        })
+        .def_property_readonly("chunks", [](py::object self) {
+            const TickStore& st = self.cast<const TickStore&>();
+            return readonly_view(st.chunks(), st.num_chunks(), self);
+        })
+        .def("lower_bound", &TickStore::lower_bound, py::arg("ts"));
+
+    // --- 二进制事件日志（mmap） ---
+
+    py::enum_<JournalKind>(m, "JournalKind")
+        .value("Sweep",  JournalKind::Sweep)
+        .value("Action", JournalKind::Action);
+
+    py::class_<EventJournal>(m, "EventJournal")
+        .def(py::init<const std::string&, uint64_t, double>(),
+             py::arg("path"), py::arg("capacity") = kDefaultJournalCapacity,
+             py::arg("flush_interval_sec") = 0.2)
+        .def("record_sweep", &EventJournal::record_sweep, py::arg("event"), py::arg("symbol_id") = 0)
+        .def("record_action", &EventJournal::record_action, py::arg("action"), py::arg("symbol_id") = 0)
+        .def("flush", &EventJournal::flush, py::call_guard<py::gil_scoped_release>())
+        .def("close", &EventJournal::close, py::call_guard<py::gil_scoped_release>())
+        .def("__enter__", [](py::object self) { return self; })
+        .def("__exit__",
+             [](EventJournal& self, py::args) {
+                 py::gil_scoped_release release;
+                 self.close();
+             })
+        .def_property_readonly("path", &EventJournal::path)
+        .def_property_readonly("capacity", &EventJournal::capacity)
+        .def_property_readonly("committed", &EventJournal::committed)
+        .def_property_readonly("dropped", &EventJournal::dropped)
+        .def_property_readonly("full", &EventJournal::full);
+
+    py::class_<JournalReader>(m, "JournalReader")
+        .def(py::init<const std::string&>(), py::arg("path"))
+        .def("__len__", &JournalReader::size)
+        // 指向 mmap 的只读结构化数组（JournalRecord 的字段）
+        .def_property_readonly("records", [](py::object self) {
+            const JournalReader& r = self.cast<const JournalReader&>();
+            return readonly_view(r.records(), r.size(), self);
+        })
+        .def_property_readonly("capacity", [](const JournalReader& r) { return r.header().capacity; })
+        .def_property_readonly("dropped", [](const JournalReader& r) { return r.header().dropped; })
+        .def_property_readonly("created_ns", [](const JournalReader& r) { return r.header().created_ns; })
+        .def_property_readonly("closed_cleanly", &JournalReader::closed_cleanly);
+
+    m.def("write_tick_store",
+          [](const std::string& path, DoubleArray ts, DoubleArray price,
+             DoubleArray volume, Int8Array side, uint64_t chunk_rows) {
+              py::ssize_t n = tick_columns_length(ts, price, volume, side);
+              py::gil_scoped_release release;
+              write_tick_store(path, ts.data(), price.data(), volume.data(), side.data(),
+                               static_cast<std::size_t>(n), chunk_rows);
+          },
+          py::arg("path"), py::arg("ts"), py::arg("price"), py::arg("volume"), py::arg("side"),
+          py::arg("chunk_rows") = kDefaultChunkRows);
+
+    m.def("convert_csv_to_tick_store",
+          [](const std::string& csv_path, const std::string& store_path,
+             uint64_t chunk_rows, unsigned num_threads) {
+              py::gil_scoped_release release;
+              return convert_csv_to_tick_store(csv_path, store_path, chunk_rows, num_threads);
+          },
+          py::arg("csv_path"), py::arg("store_path"),
+          py::arg("chunk_rows") = kDefaultChunkRows, py::arg("num_threads") = 0);
+
+    // --- 流式并行 CSV 读取 ---
+    // for ts, price, volume, side in TickCsvReader(path): model.process_ticks(ts, price, volume, side)
+
+    py::class_<TickCsvReader>(m, "TickCsvReader")
+        .def(py::init<const std::string&, std::size_t, unsigned>(),
+             py::arg("path"),
+             py::arg("batch_bytes") = static_cast<std::size_t>(64u << 20),
+             py::arg("num_threads") = 0)
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", [](TickCsvReader& self) {
+            TickBatch batch;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.next(batch);
+            }
+            if (!ok) throw py::stop_iteration();
+            return py::make_tuple(move_to_numpy(std::move(batch.ts)),
+                                  move_to_numpy(std::move(batch.price)),
+                                  move_to_numpy(std::move(batch.volume)),
+                                  move_to_numpy(std::move(batch.side)));
+        })
+        .def("count_rows", &TickCsvReader::count_rows)
+        .def_property_readonly("rows_read", &TickCsvReader::rows_read)
+        .def_property_readonly("bytes_read", &TickCsvReader::bytes_read)
+        .def_property_readonly("bytes_total", &TickCsvReader::bytes_total);
+
+    // --- sweep 事件前瞻收益 ---
+    // events 为 process_ticks 返回的 SweepEventMeta 结构化数组
+    // 返回 {"ret", "mfe", "mae"}，形状 (事件数, horizon 数)，无数据处为 NaN
+
+    m.def("event_returns",
+          [](DoubleArray ts, DoubleArray price,
+             py::array_t<SweepEventMeta, py::array::c_style> events, DoubleArray horizons) {
+              py::ssize_t n = column_length(ts, "ts");
+              if (column_length(price, "price") != n) {
+                  throw py::value_error("ts/price must have the same length");
+              }
+              py::ssize_t n_events = column_length(events, "events");
+              py::ssize_t n_h = column_length(horizons, "horizons");
+              py::array_t<double> ret({n_events, n_h}), mfe({n_events, n_h}), mae({n_events, n_h});
+              double* r = ret.mutable_data();
+              double* f = mfe.mutable_data();
+              double* a = mae.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  compute_event_returns(ts.data(), price.data(), static_cast<std::size_t>(n),
+                                        events.data(), static_cast<std::size_t>(n_events),
+                                        horizons.data(), static_cast<std::size_t>(n_h),
+                                        r, f, a);
+              }
+              py::dict out;
+              out["ret"] = ret;
+              out["mfe"] = mfe;
+              out["mae"] = mae;
+              return out;
+          },
+          py::arg("ts"), py::arg("price"), py::arg("events"), py::arg("horizons"));
+
+    // --- 多窗口买卖量（离线回填新 horizon）---
+    // 返回 {"buy", "sell", "buy_share", "sell_share"}，形状 (查询数, horizon 数)
+    // kernel："auto" / "scalar" / "avx2" / "avx512"，本机不支持时报 ValueError
+
+    m.attr("volume_kernel") = volume_kernel_name(best_volume_kernel());
+    m.def("window_volumes",
+          [](DoubleArray ts, DoubleArray volume, Int8Array side, DoubleArray query_ts,
+             DoubleArray horizons, const std::string& kernel) {
+              py::ssize_t n = column_length(ts, "ts");
+              if (column_length(volume, "volume") != n || column_length(side, "side") != n) {
+                  throw py::value_error("ts/volume/side must have the same length");
+              }
+              VolumeKernel k;
+              if (kernel == "auto") k = VolumeKernel::Auto;
+              else if (kernel == "scalar") k = VolumeKernel::Scalar;
+              else if (kernel == "avx2") k = VolumeKernel::AVX2;
+              else if (kernel == "avx512") k = VolumeKernel::AVX512;
+              else throw py::value_error("kernel must be auto, scalar, avx2 or avx512");
+
+              py::ssize_t n_q = column_length(query_ts, "query_ts");
+              py::ssize_t n_h = column_length(horizons, "horizons");
+              py::array_t<double> buy({n_q, n_h}), sell({n_q, n_h});
+              py::array_t<double> buy_share({n_q, n_h}), sell_share({n_q, n_h});
+              double* b = buy.mutable_data();
+              double* s = sell.mutable_data();
+              double* bs = buy_share.mutable_data();
+              double* ss = sell_share.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  compute_window_volumes(ts.data(), volume.data(), side.data(),
+                                         static_cast<std::size_t>(n),
+                                         query_ts.data(), static_cast<std::size_t>(n_q),
+                                         horizons.data(), static_cast<std::size_t>(n_h),
+                                         b, s, bs, ss, k);
+              }
+              py::dict out;
+              out["buy"] = buy;
+              out["sell"] = sell;
+              out["buy_share"] = buy_share;
+              out["sell_share"] = sell_share;
+              return out;
+          },
+          py::arg("ts"), py::arg("volume"), py::arg("side"), py::arg("query_ts"),
+          py::arg("horizons"), py::arg("kernel") = "auto");
+
+    // --- 热路径延迟（编译时 SWEEP_LATENCY=ON 才有数据） ---
+
+    m.attr("latency_enabled") = kLatencyEnabled;
+    // {stage: {"count", "mean_ns", "p50_ns", "p99_ns", "p999_ns", "max_ns"}}
+    m.def("latency_snapshot", []() {
+        py::dict out;
+        for (std::size_t i = 0; i < kNumLatencyStages; ++i) {
+            auto stage = static_cast<LatencyStage>(i);
+            LatencySnapshot s = latency_histogram(stage).snapshot();
+            py::dict d;
+            d["count"] = s.count;
+            d["mean_ns"] = s.mean_ns;
+            d["p50_ns"] = s.p50_ns;
+            d["p99_ns"] = s.p99_ns;
+            d["p999_ns"] = s.p999_ns;
+            d["max_ns"] = s.max_ns;
+            out[latency_stage_name(stage)] = d;
+        }
+        return out;
+    });
+    m.def("reset_latency", &reset_latency);
+    // TSC 计时时重新标定（模块加载时已标定过）；其它构建为空操作
+    m.def("latency_calibrate", &latency_calibrate);
 }
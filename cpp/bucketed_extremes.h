@@ -0,0 +1,191 @@
+// cpp/bucketed_extremes.h
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "ring_buffer.h"
+#include "state_io.h"
+
+// === 多窗口滑动极值：按固定时间桶预聚合，内存有上界 ===
+// 时间按 bucket_sec 分桶（桶号 = floor(ts / bucket_sec)），同一个桶里的值只保留最大 / 最小；
+// 窗口 w 覆盖当前桶往前 span_w = round(window_w / bucket_sec) 个桶（含当前桶），
+// 即过期的粒度是一个桶，而不是逐条 ts 比较
+// 所有窗口共用一对单调队列（按最长窗口保留），每个窗口只是一个游标，
+// 与 SweepModel 长短窗口共用 tick 缓冲的做法相同；加更多窗口只多一个游标
+// 队列元素互不同桶，长度 <= 最长窗口的桶数，构造时一次预留，之后 add / 查询都不分配
+// add / evict 均摊 O(窗口数)，查询 O(1)；ts 须不减（更早的 ts 按当前桶处理）
+class BucketedExtremes {
+public:
+    explicit BucketedExtremes(const std::vector<double>& windows_sec = {20.0, 30.0},
+                              double bucket_sec = 0.05)
+        : bucket_sec_(bucket_sec) {
+        if (!(bucket_sec_ > 0.0)) {
+            throw std::invalid_argument("BucketedExtremes: bucket_sec must be positive");
+        }
+        if (windows_sec.empty()) {
+            throw std::invalid_argument("BucketedExtremes: need at least one window");
+        }
+        int64_t max_span = 0;
+        for (double w : windows_sec) {
+            int64_t span = static_cast<int64_t>(std::llround(w / bucket_sec_));
+            if (span < 1) span = 1;
+            windows_.push_back({w, span, 0, 0});
+            if (span > max_span) max_span = span;
+        }
+        max_span_ = max_span;
+        max_q_.reserve(static_cast<std::size_t>(max_span + 1));
+        min_q_.reserve(static_cast<std::size_t>(max_span + 1));
+    }
+
+    void add(double ts, double value) {
+        evict(ts);
+        push(max_q_, value, &Window::max_cur, [](double a, double b) { return a >= b; });
+        push(min_q_, value, &Window::min_cur, [](double a, double b) { return a <= b; });
+    }
+
+    // 时间推进到 ts_now：各窗口游标越过过期的桶，最长窗口也不要的从队首弹出
+    void evict(double ts_now) {
+        int64_t idx = static_cast<int64_t>(std::floor(ts_now / bucket_sec_));
+        if (has_bucket_ && idx <= cur_) return;
+        cur_ = idx;
+        has_bucket_ = true;
+
+        for (Window& w : windows_) {
+            int64_t oldest = cur_ - w.span;  // 桶号 <= oldest 的已过期
+            while (w.max_cur < max_q_.size() && max_q_[w.max_cur].bucket <= oldest) ++w.max_cur;
+            while (w.min_cur < min_q_.size() && min_q_[w.min_cur].bucket <= oldest) ++w.min_cur;
+        }
+        drop_front(max_q_, &Window::max_cur);
+        drop_front(min_q_, &Window::min_cur);
+    }
+
+    std::size_t num_windows() const { return windows_.size(); }
+    double window_sec(std::size_t w) const { return windows_[w].sec; }
+    double bucket_sec() const { return bucket_sec_; }
+
+    bool empty(std::size_t w) const {
+        return windows_[w].max_cur == max_q_.size() || windows_[w].min_cur == min_q_.size();
+    }
+    double current_max(std::size_t w) const {
+        const Window& win = windows_[w];
+        return win.max_cur == max_q_.size() ? 0.0 : max_q_[win.max_cur].value;
+    }
+    double current_min(std::size_t w) const {
+        const Window& win = windows_[w];
+        return win.min_cur == min_q_.size() ? 0.0 : min_q_[win.min_cur].value;
+    }
+
+    // 只读查询：在 ts_now 再加入 value 后，value 是否为窗口 w 的最大 / 最小
+    // 结果与先 add(ts_now, value) 再和 current_max / current_min 比较相同，但不改状态
+    bool is_max_with(std::size_t w, double ts_now, double value) const {
+        const Entry* e = live_front(max_q_, windows_[w].max_cur, windows_[w], ts_now);
+        return !e || value >= e->value;
+    }
+    bool is_min_with(std::size_t w, double ts_now, double value) const {
+        const Entry* e = live_front(min_q_, windows_[w].min_cur, windows_[w], ts_now);
+        return !e || value <= e->value;
+    }
+
+    // 状态快照：当前桶、两个队列和各窗口游标（窗口与桶宽是构造参数，只校验不恢复）
+    void save_state(StateWriter& w) const {
+        w.put(bucket_sec_);
+        w.put(static_cast<uint64_t>(windows_.size()));
+        for (const Window& win : windows_) {
+            w.put(win.span);
+            w.put(static_cast<uint64_t>(win.max_cur));
+            w.put(static_cast<uint64_t>(win.min_cur));
+        }
+        w.put(has_bucket_);
+        w.put(cur_);
+        w.put_ring(max_q_);
+        w.put_ring(min_q_);
+    }
+
+    void load_state(StateReader& r) {
+        double bucket = r.get<double>();
+        uint64_t n = r.get<uint64_t>();
+        if (bucket != bucket_sec_ || n != windows_.size()) {
+            throw std::invalid_argument("BucketedExtremes snapshot has a different layout");
+        }
+        for (Window& win : windows_) {
+            if (r.get<int64_t>() != win.span) {
+                throw std::invalid_argument("BucketedExtremes snapshot has a different layout");
+            }
+            win.max_cur = static_cast<std::size_t>(r.get<uint64_t>());
+            win.min_cur = static_cast<std::size_t>(r.get<uint64_t>());
+        }
+        has_bucket_ = r.get<bool>();
+        cur_ = r.get<int64_t>();
+        r.get_ring(max_q_);
+        r.get_ring(min_q_);
+        for (const Window& win : windows_) {
+            if (win.max_cur > max_q_.size() || win.min_cur > min_q_.size() ||
+                max_q_.size() > static_cast<std::size_t>(max_span_ + 1) ||
+                min_q_.size() > static_cast<std::size_t>(max_span_ + 1)) {
+                throw std::runtime_error("state: corrupt extreme queues");
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        int64_t bucket;
+        double  value;
+    };
+
+    struct Window {
+        double      sec;
+        int64_t     span;     // 桶数
+        std::size_t max_cur;  // 队列里本窗口的第一个元素
+        std::size_t min_cur;
+    };
+
+    double bucket_sec_;
+    int64_t max_span_ = 0;
+    std::vector<Window> windows_;
+
+    bool    has_bucket_ = false;
+    int64_t cur_ = 0;  // 当前桶号
+
+    // 单调队列：max_q_ 值严格递减、min_q_ 值严格递增，桶号递增且互不相同
+    RingBuffer<Entry> max_q_;
+    RingBuffer<Entry> min_q_;
+
+    // dominates(new, old)：新值让旧元素不再可能成为极值
+    template <typename Dominates>
+    void push(RingBuffer<Entry>& q, double value, std::size_t Window::*cursor,
+              Dominates dominates) {
+        if (!q.empty() && q.back().bucket == cur_ && !dominates(value, q.back().value)) {
+            return;  // 同一个桶里已有更极端的值
+        }
+        while (!q.empty() && dominates(value, q.back().value)) q.pop_back();
+        for (Window& w : windows_) {
+            if (w.*cursor > q.size()) w.*cursor = q.size();
+        }
+        q.push_back({cur_, value});
+    }
+
+    // 从游标起跳过到 ts_now 时已过期的桶，返回窗口里第一个（最极端的）元素；不移动游标
+    const Entry* live_front(const RingBuffer<Entry>& q, std::size_t cur, const Window& win,
+                            double ts_now) const {
+        int64_t idx = static_cast<int64_t>(std::floor(ts_now / bucket_sec_));
+        if (has_bucket_ && idx < cur_) idx = cur_;
+        int64_t oldest = idx - win.span;
+        while (cur < q.size() && q[cur].bucket <= oldest) ++cur;
+        return cur < q.size() ? &q[cur] : nullptr;
+    }
+
+    // 最长窗口的游标之前的元素所有窗口都不要了
+    void drop_front(RingBuffer<Entry>& q, std::size_t Window::*cursor) {
+        std::size_t drop = q.size();
+        for (const Window& w : windows_) {
+            if (w.*cursor < drop) drop = w.*cursor;
+        }
+        if (drop == 0) return;
+        q.pop_front(drop);
+        for (Window& w : windows_) w.*cursor -= drop;
+    }
+};
@@ -0,0 +1,326 @@
+// cpp/bybit_feed.cpp
+#include "bybit_feed.h"
+
+#include <string_view>
+
+#include "json_scan.h"
+#include "latency.h"
+
+namespace {
+
+// 消息外层：topic / type / ts 和 data 的原文范围（字段顺序不作假设）
+struct Envelope {
+    std::string_view topic;
+    std::string_view type;
+    double ts_ms = 0.0;
+    const char* data = nullptr;
+    std::size_t data_len = 0;
+};
+
+bool parse_envelope(const char* data, std::size_t len, Envelope& env) {
+    JsonScanner js(data, len);
+    return js.for_each_member([&](std::string_view key) {
+        if (key == "topic") return js.read_string(env.topic);
+        if (key == "type") return js.read_string(env.type);
+        if (key == "ts") return js.read_number(env.ts_ms);
+        if (key == "data") {
+            js.skip_ws();
+            const char* begin = js.pos();
+            if (!js.skip_value()) return false;
+            env.data = begin;
+            env.data_len = static_cast<std::size_t>(js.pos() - begin);
+            return true;
+        }
+        return js.skip_value();
+    });
+}
+
+// orderbook.<depth>.<symbol>
+bool is_book_topic(std::string_view t, const std::string& symbol) {
+    std::string_view prefix("orderbook.");
+    if (t.size() <= prefix.size() + symbol.size() + 1) return false;
+    if (t.substr(0, prefix.size()) != prefix) return false;
+    std::string_view tail = t.substr(t.size() - symbol.size() - 1);
+    return tail[0] == '.' && tail.substr(1) == symbol;
+}
+
+// publicTrade 的 data 数组：每笔调用 fn(tick)
+template <typename Fn>
+bool for_each_trade(const char* data, std::size_t len, Fn&& fn) {
+    JsonScanner js(data, len);
+    return js.for_each_element([&]() {
+        Tick tick{0.0, 0.0, 0.0, Side::Buy};
+        bool ok = js.for_each_member([&](std::string_view key) {
+            if (key == "T") {
+                double ms = 0.0;
+                if (!js.read_number(ms)) return false;
+                tick.timestamp = ms / 1000.0;
+                return true;
+            }
+            if (key == "p") return js.read_number(tick.price);
+            if (key == "v") return js.read_number(tick.volume);
+            if (key == "S") {
+                std::string_view s;
+                if (!js.read_string(s)) return false;
+                tick.side = (s == "Buy") ? Side::Buy : Side::Sell;
+                return true;
+            }
+            return js.skip_value();
+        });
+        if (!ok) return false;
+        fn(tick);
+        return true;
+    });
+}
+
+// [["price","size"], ...] -> out（N×2 行主序）
+bool parse_levels(JsonScanner& js, std::vector<double>& out) {
+    out.clear();
+    return js.for_each_element([&]() {
+        double px = 0.0, sz = 0.0;
+        if (!js.consume('[') || !js.read_number(px) || !js.consume(',') ||
+            !js.read_number(sz) || !js.consume(']')) {
+            return false;
+        }
+        out.push_back(px);
+        out.push_back(sz);
+        return true;
+    });
+}
+
+// orderbook 的 data 对象：b / a 两侧档位
+bool parse_book(const char* data, std::size_t len,
+                std::vector<double>& bids, std::vector<double>& asks) {
+    bids.clear();
+    asks.clear();
+    JsonScanner js(data, len);
+    return js.for_each_member([&](std::string_view key) {
+        if (key == "b") return parse_levels(js, bids);
+        if (key == "a") return parse_levels(js, asks);
+        return js.skip_value();
+    });
+}
+
+}  // namespace
+
+// ---------------- BybitFeedHandler ----------------
+
+BybitFeedHandler::BybitFeedHandler(const std::string& symbol,
+                                   const SweepModel& model,
+                                   const MeanReversionStrategy& strategy,
+                                   const OrderFlowFeatureExtractor& extractor)
+    : symbol_(symbol),
+      trade_topic_("publicTrade." + symbol),
+      model_(model),
+      strategy_(strategy),
+      extractor_(extractor) {}
+
+void BybitFeedHandler::emit(const StrategyAction& act) {
+    if (act.type == StrategyActionType::Idle) return;
+    actions_.push_back(act);
+    ++stats_.actions;
+    if (journal_) journal_->record_action(act, journal_symbol_);
+}
+
+void BybitFeedHandler::on_trade(const Tick& tick) {
+    ++stats_.trades;
+    // 与 live_bybit_strategy.py 相同的顺序：sweep 检测 -> on_sweep -> on_tick
+    SweepSignal sig = model_.process_tick(tick);
+    if (sig != SweepSignal::NoSignal) {
+        ++stats_.sweeps;
+        if (journal_) {
+            for (const SweepEventMeta& ev : model_.tick_events()) {
+                journal_->record_sweep(ev, journal_symbol_);
+            }
+        }
+        emit(strategy_.on_sweep(model_.get_last_event()));
+    }
+    extractor_.add_trade(tick.timestamp, tick.price, tick.volume, tick.side);
+    // 帧调度开了 on_sweep 时，sweep 帧包含触发它的这笔成交
+    for (const SweepEventMeta& ev : model_.tick_events()) extractor_.on_sweep(ev);
+    emit(strategy_.on_tick(tick.timestamp, tick.price));
+    SWEEP_LATENCY_EXCHANGE(tick.timestamp);
+}
+
+void BybitFeedHandler::apply_book(bool snapshot) {
+    ++stats_.book_updates;
+    if (snapshot) {
+        extractor_.apply_l2_snapshot(bid_levels_.data(), bid_levels_.size() / 2,
+                                     ask_levels_.data(), ask_levels_.size() / 2);
+    } else {
+        extractor_.apply_l2_delta(bid_levels_.data(), bid_levels_.size() / 2,
+                                  ask_levels_.data(), ask_levels_.size() / 2);
+    }
+}
+
+std::size_t BybitFeedHandler::on_message(const char* data, std::size_t len) {
+    actions_.clear();
+    ++stats_.messages;
+
+    Envelope env;
+    if (!parse_envelope(data, len, env)) {
+        ++stats_.parse_errors;
+        return 0;
+    }
+    if (!env.data) {
+        ++stats_.ignored;
+        return 0;
+    }
+
+    bool ok = true;
+    if (env.topic == trade_topic_) {
+        ok = for_each_trade(env.data, env.data_len, [&](const Tick& t) { on_trade(t); });
+    } else if (is_book_topic(env.topic, symbol_)) {
+        ok = parse_book(env.data, env.data_len, bid_levels_, ask_levels_);
+        if (ok) {
+            // 定时帧先按盘口消息时间出完，再改簿（与 ReplayEngine 相同）；没有 ts 的消息不推进
+            if (env.ts_ms > 0.0) extractor_.advance_to(env.ts_ms / 1000.0);
+            apply_book(env.type == "snapshot");
+        }
+    } else {
+        ++stats_.ignored;
+        return 0;
+    }
+    if (!ok) ++stats_.parse_errors;
+    return actions_.size();
+}
+
+std::size_t BybitFeedHandler::drain(MarketQueue& queue, std::size_t max_records) {
+    actions_.clear();
+    for (std::size_t n = 0; max_records == 0 || n < max_records; ++n) {
+        const MarketRecord* r = queue.front();
+        if (!r) break;
+        switch (r->kind) {
+        case RecordKind::Trade:
+            on_trade(Tick{r->ts, r->price, r->size, r->side > 0 ? Side::Buy : Side::Sell});
+            break;
+        case RecordKind::Bid:
+            bid_levels_.push_back(r->price);
+            bid_levels_.push_back(r->size);
+            break;
+        case RecordKind::Ask:
+            ask_levels_.push_back(r->price);
+            ask_levels_.push_back(r->size);
+            break;
+        case RecordKind::BookEnd:
+            if (r->ts > 0.0) extractor_.advance_to(r->ts);
+            if (r->flags & kRecordBookGap) {
+                extractor_.apply_l2_snapshot(nullptr, 0, nullptr, 0);
+                book_stale_ = true;
+                ++stats_.book_gaps;
+            } else if (r->flags & kRecordSnapshot) {
+                apply_book(true);
+                book_stale_ = false;
+            } else if (book_stale_) {
+                ++stats_.book_skipped;
+            } else {
+                apply_book(false);
+            }
+            bid_levels_.clear();
+            ask_levels_.clear();
+            break;
+        }
+        queue.pop();
+    }
+    return actions_.size();
+}
+
+// ---------------- BybitRecordDecoder ----------------
+
+BybitRecordDecoder::BybitRecordDecoder(const std::string& symbol)
+    : symbol_(symbol), trade_topic_("publicTrade." + symbol) {}
+
+std::size_t BybitRecordDecoder::push(const char* data, std::size_t len, MarketQueue& queue) {
+    ++stats_.messages;
+    records_.clear();
+
+    Envelope env;
+    if (!parse_envelope(data, len, env)) {
+        ++stats_.parse_errors;
+        return 0;
+    }
+    if (!env.data) {
+        ++stats_.ignored;
+        return 0;
+    }
+
+    MarketRecord rec{};
+    if (gap_pending_) {
+        // 缺口标记排在本条消息前面，和它一起入队；ts=0 不推进帧调度
+        // （成交消息外层的 ts 晚于其中的成交）
+        rec.kind = RecordKind::BookEnd;
+        rec.flags = kRecordBookGap;
+        records_.push_back(rec);
+        rec = MarketRecord{};
+    }
+    bool book = false;
+    bool snapshot = false;
+    if (env.topic == trade_topic_) {
+        std::size_t first = records_.size();
+        bool ok = for_each_trade(env.data, env.data_len, [&](const Tick& t) {
+            rec.kind = RecordKind::Trade;
+            rec.ts = t.timestamp;
+            rec.price = t.price;
+            rec.size = t.volume;
+            rec.side = static_cast<int8_t>(t.side);
+            records_.push_back(rec);
+        });
+        if (!ok) {
+            ++stats_.parse_errors;
+            return 0;
+        }
+        stats_.trades += static_cast<int64_t>(records_.size() - first);
+    } else if (is_book_topic(env.topic, symbol_)) {
+        if (!parse_book(env.data, env.data_len, bids_, asks_)) {
+            ++stats_.parse_errors;
+            return 0;
+        }
+        book = true;
+        snapshot = env.type == "snapshot";
+        if (book_gap_ && !snapshot) {
+            // 缺了一次更新的簿上再叠 delta 没有意义，等 snapshot
+            ++stats_.book_skipped;
+            bids_.clear();
+            asks_.clear();
+            book = false;
+        }
+        rec.kind = RecordKind::Bid;
+        for (std::size_t i = 0; i + 1 < bids_.size(); i += 2) {
+            rec.price = bids_[i];
+            rec.size = bids_[i + 1];
+            records_.push_back(rec);
+        }
+        rec.kind = RecordKind::Ask;
+        for (std::size_t i = 0; i + 1 < asks_.size(); i += 2) {
+            rec.price = asks_[i];
+            rec.size = asks_[i + 1];
+            records_.push_back(rec);
+        }
+        if (book) {
+            rec.kind = RecordKind::BookEnd;
+            rec.ts = env.ts_ms / 1000.0;
+            rec.price = 0.0;
+            rec.size = 0.0;
+            rec.flags = snapshot ? kRecordSnapshot : 0;
+            records_.push_back(rec);
+            ++stats_.book_updates;
+        }
+    } else {
+        ++stats_.ignored;
+        return 0;
+    }
+
+    if (records_.empty()) return 0;
+    if (!queue.push(records_.data(), records_.size())) {
+        if (book) {
+            // 这条盘口更新丢了：消费端的簿从此不可信，要先送缺口标记
+            ++stats_.book_gaps;
+            book_gap_ = true;
+            gap_pending_ = true;
+        }
+        return 0;
+    }
+    gap_pending_ = false;
+    if (snapshot) book_gap_ = false;
+    return records_.size();
+}
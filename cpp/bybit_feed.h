@@ -0,0 +1,118 @@
+// cpp/bybit_feed.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sweep_model.h"
+#include "mean_reversion_strategy.h"
+#include "orderflow_features.h"
+#include "market_queue.h"
+#include "event_journal.h"
+
+struct FeedStats {
+    int64_t messages = 0;
+    int64_t trades = 0;
+    int64_t book_updates = 0;
+    int64_t sweeps = 0;
+    int64_t actions = 0;
+    int64_t ignored = 0;       // 非订阅 topic / 订阅回执等
+    int64_t parse_errors = 0;
+    // 盘口缺口：decoder 为因队列满丢掉的盘口消息数，handler 为收到缺口标记、清空簿的次数
+    int64_t book_gaps = 0;
+    int64_t book_skipped = 0;  // 缺口后、下一条 snapshot 前丢弃的 delta
+};
+
+// === Bybit v5 行情消息直通：原始 JSON -> SweepModel / 策略 / 特征 ===
+// publicTrade.<symbol>：逐笔 process_tick -> on_sweep -> add_trade -> on_tick
+// orderbook.<depth>.<symbol>：snapshot / delta 写入 extractor 的 L2 簿
+// 只有非 Idle 的 StrategyAction 会留给调用方（actions()）
+// 两种输入任选其一，同一个实例不要混用：
+//   on_message：在调用线程里解析 + 计算
+//   drain：接收线程用 BybitRecordDecoder 解析入队，策略线程从 MarketQueue 取记录计算
+class BybitFeedHandler {
+public:
+    BybitFeedHandler(const std::string& symbol,
+                     const SweepModel& model = SweepModel(),
+                     const MeanReversionStrategy& strategy = MeanReversionStrategy(),
+                     const OrderFlowFeatureExtractor& extractor = OrderFlowFeatureExtractor());
+
+    // 处理一条 WebSocket 消息，返回本条消息产生的动作数
+    std::size_t on_message(const char* data, std::size_t len);
+
+    // 处理队列里的记录（max_records=0 表示取空为止），返回产生的动作数
+    std::size_t drain(MarketQueue& queue, std::size_t max_records = 0);
+
+    // 最近一次 on_message / drain 产生的非 Idle 动作（下一次调用时清空）
+    const std::vector<StrategyAction>& actions() const { return actions_; }
+
+    const FeedStats& stats() const { return stats_; }
+    const std::string& symbol() const { return symbol_; }
+
+    // 队列里丢过盘口更新、还没等到新的 snapshot：簿已清空，盘口特征不可用
+    // Bybit 只在（重新）订阅时推 snapshot，调用方看到后应重新订阅盘口
+    bool book_stale() const { return book_stale_; }
+
+    // 把每个 sweep 事件和非 Idle 动作写进二进制日志（symbol 为记录里的编号）；nullptr 关闭
+    // journal 由调用方持有，须比本对象活得久
+    void set_journal(EventJournal* journal, uint32_t symbol = 0) {
+        journal_ = journal;
+        journal_symbol_ = symbol;
+    }
+
+    SweepModel& model() { return model_; }
+    MeanReversionStrategy& strategy() { return strategy_; }
+    OrderFlowFeatureExtractor& extractor() { return extractor_; }
+
+private:
+    std::string symbol_;
+    std::string trade_topic_;
+
+    SweepModel model_;
+    MeanReversionStrategy strategy_;
+    OrderFlowFeatureExtractor extractor_;
+
+    std::vector<StrategyAction> actions_;
+    FeedStats stats_;
+    bool book_stale_ = false;
+
+    EventJournal* journal_ = nullptr;
+    uint32_t journal_symbol_ = 0;
+
+    // 盘口解析的复用缓冲（N×2 price,size）
+    std::vector<double> bid_levels_;
+    std::vector<double> ask_levels_;
+
+    void on_trade(const Tick& tick);
+    void apply_book(bool snapshot);  // 用 bid_levels_ / ask_levels_
+    void emit(const StrategyAction& act);
+};
+
+// === 接收线程用：只解析，不计算 ===
+// 一条消息拆成 MarketRecord 整体入队（成交各一条；盘口每档一条 + BookEnd）
+// 盘口消息入队失败后簿就缺了一次更新：之后第一条入队的消息前面带一个缺口标记
+// （BookEnd + kRecordBookGap，drain 收到后清空簿），下一条 snapshot 之前的 delta 直接丢弃
+// stats 里 actions / sweeps 没有意义
+class BybitRecordDecoder {
+public:
+    explicit BybitRecordDecoder(const std::string& symbol);
+
+    // 返回入队的记录数；无关 topic / 解析失败 / 队列放不下（计入 queue.dropped）时为 0
+    std::size_t push(const char* data, std::size_t len, MarketQueue& queue);
+
+    const FeedStats& stats() const { return stats_; }
+    const std::string& symbol() const { return symbol_; }
+
+private:
+    std::string symbol_;
+    std::string trade_topic_;
+    FeedStats stats_;
+
+    std::vector<MarketRecord> records_;
+    std::vector<double> bids_;
+    std::vector<double> asks_;
+
+    bool book_gap_ = false;      // 丢过盘口消息，还没入队 snapshot
+    bool gap_pending_ = false;   // 缺口标记还没送进队列
+};
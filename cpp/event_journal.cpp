@@ -0,0 +1,289 @@
+// cpp/event_journal.cpp
+#include "event_journal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void fail(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + ": " + path + " (" + std::strerror(errno) + ")");
+}
+
+std::size_t page_size() {
+    static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+}
+
+int64_t realtime_ns() {
+    struct timespec t;
+    ::clock_gettime(CLOCK_REALTIME, &t);
+    return static_cast<int64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+bool valid_header(const JournalHeader& h) {
+    return std::memcmp(h.magic, kJournalMagic, sizeof(h.magic)) == 0 &&
+           h.version == kJournalVersion &&
+           h.record_bytes == sizeof(JournalRecord) &&
+           h.header_bytes >= sizeof(JournalHeader);
+}
+
+uint64_t load_seq(const JournalRecord& r) {
+    return __atomic_load_n(&r.seq, __ATOMIC_ACQUIRE);
+}
+
+}  // namespace
+
+// ---------------- EventJournal ----------------
+
+EventJournal::EventJournal(const std::string& path, uint64_t capacity, double flush_interval_sec)
+    : path_(path), flush_interval_sec_(flush_interval_sec) {
+    if (capacity == 0) capacity = kDefaultJournalCapacity;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) fail("cannot open", path);
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        fail("cannot stat", path);
+    }
+
+    JournalHeader h;
+    std::memset(&h, 0, sizeof(h));
+    bool resume = st.st_size > 0;
+    if (resume) {
+        // 已有文件：必须是同版本的日志，否则不碰它
+        if (static_cast<std::size_t>(st.st_size) < sizeof(h) ||
+            ::pread(fd_, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+            !valid_header(h) ||
+            static_cast<uint64_t>(st.st_size) < h.header_bytes + h.capacity * sizeof(JournalRecord)) {
+            ::close(fd_);
+            throw std::runtime_error("not a compatible event journal: " + path);
+        }
+        capacity = h.capacity;
+    } else {
+        std::memcpy(h.magic, kJournalMagic, sizeof(h.magic));
+        h.version = kJournalVersion;
+        h.record_bytes = sizeof(JournalRecord);
+        h.header_bytes = page_size();
+        h.capacity = capacity;
+        h.created_ns = realtime_ns();
+    }
+    capacity_ = capacity;
+    bytes_ = static_cast<std::size_t>(h.header_bytes + capacity_ * sizeof(JournalRecord));
+
+    if (!resume) {
+        // 先把磁盘块分配好：之后写映射页不会因为空间不足收到 SIGBUS
+        int err = ::posix_fallocate(fd_, 0, static_cast<off_t>(bytes_));
+        if (err == EOPNOTSUPP || err == EINVAL) {
+            err = ::ftruncate(fd_, static_cast<off_t>(bytes_)) == 0 ? 0 : errno;
+        }
+        if (err != 0) {
+            ::close(fd_);
+            errno = err;
+            fail("cannot allocate", path);
+        }
+    }
+
+    void* p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd_);
+        fail("cannot mmap", path);
+    }
+    base_ = static_cast<char*>(p);
+    records_ = reinterpret_cast<JournalRecord*>(base_ + h.header_bytes);
+
+    uint64_t n = 0;
+    if (resume) {
+        // 接着最后一条连续的有效记录写；其后残留的（崩溃时没写完的那几个槽附近）清掉，
+        // 免得新记录补上空缺后把旧的接进来
+        n = std::min(h.committed, capacity_);
+        while (n < capacity_ && records_[n].seq == n + 1) ++n;
+        for (uint64_t i = n, empty = 0; i < capacity_ && empty < 64; ++i) {
+            if (records_[i].seq != 0) {
+                records_[i].seq = 0;
+                empty = 0;
+            } else {
+                ++empty;
+            }
+        }
+        dropped_.store(h.dropped, std::memory_order_relaxed);
+    }
+    h.committed = n;
+    h.closed = 0;
+    std::memcpy(base_, &h, sizeof(h));
+    next_.store(n, std::memory_order_relaxed);
+    committed_.store(n, std::memory_order_relaxed);
+    synced_bytes_ = static_cast<std::size_t>(h.header_bytes + n * sizeof(JournalRecord)) /
+                    page_size() * page_size();
+
+    prefaulted_ = n;
+    prefault();
+    flusher_ = std::thread([this] { run_flusher(); });
+}
+
+EventJournal::~EventJournal() {
+    close();
+    ::munmap(base_, bytes_);
+    ::close(fd_);
+}
+
+bool EventJournal::append(const JournalRecord& r) {
+    // 与 close() 的 closed_ / writers_ 成对（seq_cst）：要么这里看到已关闭，要么 close 等这次写完
+    writers_.fetch_add(1, std::memory_order_seq_cst);
+    if (closed_.load(std::memory_order_seq_cst)) {
+        writers_.fetch_sub(1, std::memory_order_release);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint64_t slot = next_.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= capacity_) {
+        writers_.fetch_sub(1, std::memory_order_release);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 先写内容，最后 release 写 seq：flush 线程 / 读端看到 seq 就能看到整条记录
+    JournalRecord* dst = records_ + slot;
+    std::memcpy(reinterpret_cast<char*>(dst) + sizeof(dst->seq),
+                reinterpret_cast<const char*>(&r) + sizeof(r.seq),
+                sizeof(JournalRecord) - sizeof(r.seq));
+    __atomic_store_n(&dst->seq, slot + 1, __ATOMIC_RELEASE);
+    writers_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+bool EventJournal::record_sweep(const SweepEventMeta& ev, uint32_t symbol) {
+    JournalRecord r;
+    r.seq = 0;
+    r.local_ns = realtime_ns();
+    r.exchange_ts = ev.ts_end;
+    r.symbol = symbol;
+    r.kind = static_cast<uint8_t>(JournalKind::Sweep);
+    r.action = 0;
+    r.dir = static_cast<int8_t>(ev.direction);
+    r.pad = 0;
+    r.price = ev.price_end;
+    r.ts_start = ev.ts_start;
+    r.price_start = ev.price_start;
+    r.volume = ev.volume_total;
+    return append(r);
+}
+
+bool EventJournal::record_action(const StrategyAction& act, uint32_t symbol) {
+    JournalRecord r;
+    r.seq = 0;
+    r.local_ns = realtime_ns();
+    r.exchange_ts = act.ts;
+    r.symbol = symbol;
+    r.kind = static_cast<uint8_t>(JournalKind::Action);
+    r.action = static_cast<uint8_t>(act.type);
+    r.dir = static_cast<int8_t>(act.dir);
+    r.pad = 0;
+    r.price = act.price;
+    r.ts_start = 0.0;
+    r.price_start = 0.0;
+    r.volume = 0.0;
+    return append(r);
+}
+
+void EventJournal::sync(bool all) {
+    std::lock_guard<std::mutex> lk(sync_mu_);
+    const std::size_t page = page_size();
+    JournalHeader& h = header();
+
+    // 推进连续写完的前缀；领了槽还没写完的会挡住后面的，下一轮再看
+    uint64_t limit = std::min(next_.load(std::memory_order_acquire), capacity_);
+    uint64_t c = committed_.load(std::memory_order_relaxed);
+    while (c < limit && load_seq(records_[c]) == c + 1) ++c;
+    committed_.store(c, std::memory_order_release);
+
+    // 平时只同步写满的页，还在写的页留到写满或 flush() 时再回写
+    std::size_t end = static_cast<std::size_t>(h.header_bytes + c * sizeof(JournalRecord));
+    std::size_t full = end / page * page;
+    std::size_t target = all ? end : full;
+    if (target > synced_bytes_) {
+        ::msync(base_ + synced_bytes_, target - synced_bytes_, MS_SYNC);
+        synced_bytes_ = full;
+    }
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (h.committed != c || h.dropped != dropped || all) {
+        h.committed = c;
+        h.dropped = dropped;
+        ::msync(base_, page, MS_SYNC);
+    }
+}
+
+// 共享文件映射的页第一次被写时要走缺页（分配页缓存、文件系统 page_mkwrite），
+// 这里替记录线程先写一次：对每页第一个槽的 seq 原子加 0，不改内容，
+// 记录线程对 seq 也只做原子写，两边不冲突
+void EventJournal::prefault() {
+    const uint64_t per_page = page_size() / sizeof(JournalRecord);
+    uint64_t next = std::min(next_.load(std::memory_order_relaxed), capacity_);
+    uint64_t target = std::min(capacity_, next + kJournalPrefaultBytes / sizeof(JournalRecord));
+    uint64_t slot = std::max(prefaulted_, next);
+    slot = slot / per_page * per_page;
+    for (; slot < target; slot += per_page) {
+        __atomic_fetch_add(&records_[slot].seq, 0, __ATOMIC_RELAXED);
+    }
+    prefaulted_ = std::max(prefaulted_, target);
+}
+
+void EventJournal::run_flusher() {
+    const auto interval = std::chrono::duration<double>(flush_interval_sec_ > 0.0 ? flush_interval_sec_ : 0.2);
+    std::unique_lock<std::mutex> lk(stop_mu_);
+    while (!stop_) {
+        if (stop_cv_.wait_for(lk, interval, [this] { return stop_; })) break;
+        lk.unlock();
+        prefault();
+        sync(false);
+        lk.lock();
+    }
+}
+
+void EventJournal::flush() {
+    sync(true);
+}
+
+void EventJournal::close() {
+    if (closed_.exchange(true, std::memory_order_seq_cst)) return;
+    // 等已经过了 closed_ 检查的记录线程写完：之后的最后一次同步 / 析构里的 munmap 不会碰上它们
+    while (writers_.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+    {
+        std::lock_guard<std::mutex> lk(stop_mu_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (flusher_.joinable()) flusher_.join();
+
+    header().closed = 1;
+    sync(true);
+}
+
+// ---------------- JournalReader ----------------
+
+JournalReader::JournalReader(const std::string& path) : file_(path) {
+    if (file_.size() < sizeof(JournalHeader)) {
+        throw std::runtime_error("not an event journal: " + path);
+    }
+    header_ = reinterpret_cast<const JournalHeader*>(file_.data());
+    if (!valid_header(*header_)) {
+        throw std::runtime_error("not a compatible event journal: " + path);
+    }
+    uint64_t capacity = header_->capacity;
+    if (file_.size() < header_->header_bytes) capacity = 0;
+    else capacity = std::min<uint64_t>(capacity, (file_.size() - header_->header_bytes) / sizeof(JournalRecord));
+    records_ = reinterpret_cast<const JournalRecord*>(file_.data() + header_->header_bytes);
+
+    uint64_t n = std::min(header_->committed, capacity);
+    while (n < capacity && records_[n].seq == n + 1) ++n;
+    size_ = static_cast<std::size_t>(n);
+}
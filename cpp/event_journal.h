@@ -0,0 +1,145 @@
+// cpp/event_journal.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "mapped_file.h"
+#include "mean_reversion_strategy.h"
+#include "sweep_model.h"
+
+// === 二进制事件日志：sweep 事件 / 策略动作，定长记录，mmap 追加写 ===
+// 布局：
+//   [JournalHeader]（占满第一页，之后的记录与头不共页）
+//   JournalRecord[capacity]：第 i 条的 seq = i + 1；seq 为 0 的槽还没写（或没写完）
+// 文件创建时按 capacity 一次分配好（posix_fallocate）并映射；flush 线程提前对写入位置之后几 MiB 的页
+// 做写缺页，记录时只是原子领一个槽（外加在途计数）+ 拷贝 64 字节 + release 写 seq：不加锁、不分配、不调系统调用，
+// 多个线程可以同时记录（SymbolEngine 的各 worker 共用一个日志）
+// 后台 flush 线程按间隔推进已提交的记录数、msync 已写满的页并更新文件头；
+// 进程崩溃时已写入的记录仍在页缓存里，读端会越过文件头的计数继续按 seq 找回
+// 写满后新记录丢弃并计数（dropped()，也写进文件头），不会阻塞记录线程；full() 为真后要换文件才能继续记
+// close() 先等进行中的记录写完再做最后一次同步，析构（munmap）不会和记录线程交错
+// 字节序为本机字节序（与 tick_store 一致）；出错抛 std::runtime_error
+
+constexpr char kJournalMagic[8] = {'S', 'W', 'J', 'R', 'N', 'L', '0', '1'};
+constexpr uint32_t kJournalVersion = 1;
+constexpr uint64_t kDefaultJournalCapacity = 1 << 20;  // 64 MiB
+constexpr std::size_t kJournalPrefaultBytes = 4 << 20;
+
+enum class JournalKind : uint8_t {
+    Sweep  = 1,
+    Action = 2
+};
+
+// 定长记录（64 字节）
+struct JournalRecord {
+    uint64_t seq;          // 从 1 开始连续
+    int64_t  local_ns;     // 记录时的本地时间（CLOCK_REALTIME，ns）
+    double   exchange_ts;  // 交易所时间（秒）：Sweep 为 ts_end，Action 为 act.ts
+    uint32_t symbol;       // 调用方的 symbol 编号（SymbolEngine 的 add_symbol 返回值）
+    uint8_t  kind;         // JournalKind
+    uint8_t  action;       // Action：StrategyActionType
+    int8_t   dir;          // Sweep：direction；Action：act.dir
+    uint8_t  pad;
+    double   price;        // Sweep：price_end；Action：act.price
+    double   ts_start;     // 以下只对 Sweep 有意义
+    double   price_start;
+    double   volume;       // volume_total
+};
+static_assert(sizeof(JournalRecord) == 64, "JournalRecord must stay 64 bytes");
+
+struct JournalHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_bytes;   // sizeof(JournalRecord)
+    uint64_t header_bytes;   // 第一条记录的偏移
+    uint64_t capacity;
+    uint64_t committed;      // flush 线程确认的连续记录数
+    uint64_t dropped;        // 写满后丢弃的记录数
+    int64_t  created_ns;
+    uint8_t  closed;         // 正常关闭时为 1
+    uint8_t  pad[7];
+};
+
+class EventJournal {
+public:
+    // 文件不存在时创建；已是日志文件时接着最后一条有效记录追加（capacity 以文件为准）
+    // flush_interval_sec：后台线程的同步间隔
+    explicit EventJournal(const std::string& path,
+                          uint64_t capacity = kDefaultJournalCapacity,
+                          double flush_interval_sec = 0.2);
+    ~EventJournal();  // 同 close()
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    // ---- 记录线程（任意个）----
+    // 写满或已关闭时返回 false 并计入 dropped
+    bool record_sweep(const SweepEventMeta& ev, uint32_t symbol = 0);
+    bool record_action(const StrategyAction& act, uint32_t symbol = 0);
+
+    // ---- 控制 ----
+    // 立即同步已写入的全部记录（包括未写满的页）和文件头，阻塞到落盘
+    void flush();
+    // 停止 flush 线程，最后一次同步并标记正常关闭；可重复调用，之后的记录都会被丢弃
+    void close();
+
+    const std::string& path() const { return path_; }
+    uint64_t capacity() const { return capacity_; }
+    uint64_t committed() const { return committed_.load(std::memory_order_acquire); }
+    // 写满 / 关闭后被丢弃的记录数
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    bool full() const { return next_.load(std::memory_order_relaxed) >= capacity_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    char* base_ = nullptr;
+    std::size_t bytes_ = 0;
+    uint64_t capacity_ = 0;
+    JournalRecord* records_ = nullptr;
+
+    std::atomic<uint64_t> next_{0};       // 下一个待领的槽
+    std::atomic<uint64_t> committed_{0};  // [0, committed) 已全部写完
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> closed_{false};
+    std::atomic<uint32_t> writers_{0};    // 正在 append 的记录线程数
+
+    std::size_t synced_bytes_ = 0;  // 已 msync 的文件前缀（整页）
+    uint64_t prefaulted_ = 0;       // [0, prefaulted_) 的槽所在页已做过写缺页
+    std::mutex sync_mu_;            // flush 线程与 flush() / close() 互斥
+
+    double flush_interval_sec_;
+    std::thread flusher_;
+    std::mutex stop_mu_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+
+    JournalHeader& header() { return *reinterpret_cast<JournalHeader*>(base_); }
+
+    bool append(const JournalRecord& r);
+    void sync(bool all);  // all=false 时只同步已写满的页
+    void prefault();      // 写入位置之后 kJournalPrefaultBytes 内的页先做写缺页
+    void run_flusher();
+};
+
+// 只读查看（mmap）；读到文件头记录的条数之后，继续收下 seq 连续的记录（崩溃前写入、未来得及 flush 的）
+class JournalReader {
+public:
+    explicit JournalReader(const std::string& path);
+
+    std::size_t size() const { return size_; }
+    const JournalRecord* records() const { return records_; }
+    const JournalHeader& header() const { return *header_; }
+    bool closed_cleanly() const { return header_->closed != 0; }
+
+private:
+    MappedFile file_;
+    const JournalHeader* header_ = nullptr;
+    const JournalRecord* records_ = nullptr;
+    std::size_t size_ = 0;
+};
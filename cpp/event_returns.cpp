@@ -0,0 +1,73 @@
+// cpp/event_returns.cpp
+#include "event_returns.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "ring_buffer.h"
+
+void compute_event_returns(const double* ts, const double* price, std::size_t n,
+                           const SweepEventMeta* events, std::size_t n_events,
+                           const double* horizons, std::size_t n_horizons,
+                           double* ret_out, double* mfe_out, double* mae_out) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<std::size_t> order(n_events);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return events[a].ts_end < events[b].ts_end;
+    });
+
+    RingBuffer<std::size_t> max_q(1024);  // 窗口内价格单调递减的下标
+    RingBuffer<std::size_t> min_q(1024);  // 窗口内价格单调递增的下标
+
+    for (std::size_t k = 0; k < n_horizons; ++k) {
+        const double horizon = horizons[k];
+        std::size_t lo = 0;  // 第一条 ts >= t0
+        std::size_t hi = 0;  // 第一条 ts > t0 + horizon
+        max_q.clear();
+        min_q.clear();
+
+        for (std::size_t e : order) {
+            const SweepEventMeta& ev = events[e];
+            const double t0 = ev.ts_end;
+            const double t1 = t0 + horizon;
+            const std::size_t out = e * n_horizons + k;
+
+            while (lo < n && ts[lo] < t0) ++lo;
+            while (!max_q.empty() && max_q.front() < lo) max_q.pop_front();
+            while (!min_q.empty() && min_q.front() < lo) min_q.pop_front();
+            if (hi < lo) hi = lo;
+
+            while (hi < n && ts[hi] <= t1) {
+                double p = price[hi];
+                while (!max_q.empty() && price[max_q.back()] <= p) max_q.pop_back();
+                max_q.push_back(hi);
+                while (!min_q.empty() && price[min_q.back()] >= p) min_q.pop_back();
+                min_q.push_back(hi);
+                ++hi;
+            }
+
+            if (lo >= n || hi == lo) {
+                ret_out[out] = nan;
+                mfe_out[out] = nan;
+                mae_out[out] = nan;
+                continue;
+            }
+
+            const double p0 = price[lo];
+            const double up = (price[max_q.front()] - p0) / p0;
+            const double dn = (price[min_q.front()] - p0) / p0;
+            ret_out[out] = (price[hi - 1] - p0) / p0;
+            if (ev.direction < 0) {
+                mfe_out[out] = dn;
+                mae_out[out] = up;
+            } else {
+                mfe_out[out] = up;
+                mae_out[out] = dn;
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+// cpp/event_returns.h
+#pragma once
+#include <cstddef>
+
+#include "sweep_model.h"  // SweepEventMeta
+
+// === sweep 事件前瞻收益：多 horizon 的 ret / MFE / MAE ===
+// 对每个事件取 t0 = ts_end，p0 为第一条 ts >= t0 的成交价，窗口为 [t0, t0 + horizon] 内的成交：
+//   ret = (p_T - p0) / p0，p_T 为窗口内最后一笔
+//   上行事件（direction >= 0）：MFE = (max - p0) / p0，MAE = (min - p0) / p0
+//   下行事件（direction < 0） ：MFE = (min - p0) / p0，MAE = (max - p0) / p0
+// 与 offline_analyze.py::compute_ret_mfe_mae 口径一致；t0 之后没有成交或窗口为空时写 NaN
+//
+// ts / price 须按时间升序；事件顺序任意（内部按 ts_end 排序，输出仍按输入顺序）
+// 每个 horizon 用双指针 + 单调队列求区间极值，O(n + E log E)
+// 输出为 [事件][horizon] 行主序，各 n_events * n_horizons 个
+void compute_event_returns(const double* ts, const double* price, std::size_t n,
+                           const SweepEventMeta* events, std::size_t n_events,
+                           const double* horizons, std::size_t n_horizons,
+                           double* ret_out, double* mfe_out, double* mae_out);
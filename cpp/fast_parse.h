@@ -0,0 +1,33 @@
+// cpp/fast_parse.h
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+// 数字字符串 -> double（std::from_chars，不分配、不依赖 locale）
+// 整段都必须是数字才算成功
+inline bool parse_double(const char* first, const char* last, double& out) {
+    if (first != last && *first == '+') ++first;  // from_chars 不接受前导 '+'
+    auto res = std::from_chars(first, last, out);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+inline bool parse_double(const char* s, std::size_t len, double& out) {
+    return parse_double(s, s + len, out);
+}
+
+// 成交方向：B / Buy -> +1，S / Sell -> -1（大小写敏感，与 Bybit / fetch_trades_eth.py 一致）
+inline bool parse_side(const char* first, const char* last, int8_t& out) {
+    std::size_t len = static_cast<std::size_t>(last - first);
+    if (len == 0) return false;
+    if (*first == 'B' && (len == 1 || (len == 3 && first[1] == 'u' && first[2] == 'y'))) {
+        out = 1;
+        return true;
+    }
+    if (*first == 'S' && (len == 1 || (len == 4 && first[1] == 'e' && first[2] == 'l' && first[3] == 'l'))) {
+        out = -1;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,222 @@
+// cpp/fill_simulator.cpp
+#include "fill_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// 挂单价与成交价比较的相对容差（同一价位的 tick 换算误差）
+constexpr double kPriceEps = 1e-9;
+
+void check_model(const FillModel& m) {
+    if (!(m.order_qty > 0.0)) throw std::invalid_argument("FillModel: order_qty must be > 0");
+    if (!(m.limit_timeout_sec >= 0.0)) {
+        throw std::invalid_argument("FillModel: limit_timeout_sec must be >= 0");
+    }
+    if (!(m.latency_ms >= 0.0) || !(m.jitter_ms >= 0.0)) {
+        throw std::invalid_argument("FillModel: latency_ms / jitter_ms must be >= 0");
+    }
+    if (m.latency == LatencyDist::Empirical) {
+        if (m.latency_samples_ms.empty()) {
+            throw std::invalid_argument("FillModel: Empirical latency needs latency_samples_ms");
+        }
+        for (double v : m.latency_samples_ms) {
+            if (!(v >= 0.0)) throw std::invalid_argument("FillModel: latency samples must be >= 0");
+        }
+    }
+    if (!(m.tick_size > 0.0)) throw std::invalid_argument("FillModel: tick_size must be > 0");
+}
+
+}  // namespace
+
+FillSimulator::FillSimulator(const FillModel& model) : model_(model), rng_(model.seed) {
+    check_model(model_);
+    pending_.reserve(4);
+    fills_.reserve(4);
+}
+
+double FillSimulator::sample_latency_sec() {
+    double ms = model_.latency_ms;
+    switch (model_.latency) {
+    case LatencyDist::Fixed:
+        break;
+    case LatencyDist::Uniform:
+        ms += model_.jitter_ms * std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+        break;
+    case LatencyDist::Exponential:
+        if (model_.jitter_ms > 0.0) {
+            ms += std::exponential_distribution<double>(1.0 / model_.jitter_ms)(rng_);
+        }
+        break;
+    case LatencyDist::Empirical: {
+        const std::vector<double>& s = model_.latency_samples_ms;
+        ms += s[std::uniform_int_distribution<std::size_t>(0, s.size() - 1)(rng_)];
+        break;
+    }
+    }
+    stats_.latency_ms += ms;
+    return ms / 1000.0;
+}
+
+void FillSimulator::submit(const StrategyAction& act) {
+    if (act.type == StrategyActionType::Idle) return;
+    if (head_ == pending_.size()) {
+        pending_.clear();
+        head_ = 0;
+    }
+    Order o;
+    o.arrival = std::max(act.ts + sample_latency_sec(), last_arrival_);
+    o.signal_price = act.price;
+    o.dir = act.dir;
+    o.entry = act.type != StrategyActionType::Close;
+    last_arrival_ = o.arrival;
+    pending_.push_back(o);
+    ++stats_.orders;
+}
+
+void FillSimulator::advance_to(double ts, const L2Book& book) {
+    // 在途订单到达和挂单超时按时间先后处理
+    for (;;) {
+        double t_order = head_ < pending_.size() ? pending_[head_].arrival : INFINITY;
+        double t_rest = resting_ ? rest_deadline_ : INFINITY;
+        if (t_order > ts && t_rest > ts) break;
+        if (t_rest <= t_order) {
+            expire(book);
+        } else {
+            Order o = pending_[head_++];
+            execute(o, o.arrival, book);
+        }
+    }
+}
+
+void FillSimulator::execute(const Order& o, double ts, const L2Book& book) {
+    if (o.entry) {
+        if (pos_dir_ != 0 || resting_) {
+            ++stats_.missed_entries;
+            return;
+        }
+        if (model_.entry == OrderStyle::Limit) {
+            place_limit(o, o.dir, ts, book);
+        } else {
+            fill_market(o, o.dir, ts, book);
+        }
+        return;
+    }
+
+    // 平仓信号到达时开仓限价单还没成交：撤单，这一笔没做成
+    if (resting_ && rest_.entry) {
+        resting_ = false;
+        ++stats_.missed_entries;
+        return;
+    }
+    if (pos_dir_ == 0 || resting_) return;
+    if (model_.exit == OrderStyle::Limit) {
+        place_limit(o, -pos_dir_, ts, book);
+    } else {
+        fill_market(o, -pos_dir_, ts, book);
+    }
+}
+
+void FillSimulator::place_limit(const Order& o, int side, double ts, const L2Book& book) {
+    double price = side > 0 ? book.best_bid() : book.best_ask();
+    double ahead = 0.0;
+    if (price > 0.0) {
+        ahead = side > 0 ? book.bid_size_at(price) : book.ask_size_at(price);
+    } else {
+        price = last_price_ > 0.0 ? last_price_ : o.signal_price;
+    }
+    resting_ = true;
+    rest_ = o;
+    rest_side_ = side;
+    rest_price_ = price;
+    rest_ahead_ = ahead;
+    rest_deadline_ = ts + model_.limit_timeout_sec;
+}
+
+void FillSimulator::fill_market(const Order& o, int side, double ts, const L2Book& book) {
+    double price = book.market_price(side, model_.order_qty);
+    if (!(price > 0.0)) price = last_price_ > 0.0 ? last_price_ : o.signal_price;
+    fill(o, side, ts, price, false);
+}
+
+void FillSimulator::fill(const Order& o, int side, double ts, double price, bool maker) {
+    double fee = maker ? model_.maker_fee_bp : model_.taker_fee_bp;
+    if (o.signal_price > 0.0) {
+        stats_.slippage_bp += (price - o.signal_price) / o.signal_price * 10000.0 * side;
+    }
+    stats_.fees_bp += fee;
+    if (maker) {
+        ++stats_.limit_fills;
+    } else {
+        ++stats_.market_fills;
+    }
+
+    SimFill f;
+    f.ts = ts;
+    f.price = price;
+    f.signal_price = o.signal_price;
+    f.fee_bp = fee;
+    f.dir = o.entry ? o.dir : pos_dir_;
+    f.entry = o.entry ? 1 : 0;
+    f.maker = maker ? 1 : 0;
+    fills_.push_back(f);
+    pos_dir_ = o.entry ? o.dir : 0;
+}
+
+void FillSimulator::expire(const L2Book& book) {
+    resting_ = false;
+    if (rest_.entry) {
+        ++stats_.missed_entries;
+        return;
+    }
+    ++stats_.limit_to_market;
+    fill_market(rest_, rest_side_, rest_deadline_, book);
+}
+
+void FillSimulator::on_trade(double ts, double price, double volume, Side side) {
+    last_price_ = price;
+    if (!resting_) return;
+
+    double eps = kPriceEps * rest_price_;
+    bool through = false;
+    if (rest_side_ > 0) {
+        // 买单：低于挂单价的成交说明这一价位已被吃穿；同价位的卖方主动成交消耗队列
+        if (price < rest_price_ - eps) {
+            through = true;
+        } else if (side == Side::Sell && price <= rest_price_ + eps) {
+            rest_ahead_ -= volume;
+        }
+    } else {
+        if (price > rest_price_ + eps) {
+            through = true;
+        } else if (side == Side::Buy && price >= rest_price_ - eps) {
+            rest_ahead_ -= volume;
+        }
+    }
+    if (through || rest_ahead_ <= -model_.order_qty) {
+        resting_ = false;
+        fill(rest_, rest_side_, ts, rest_price_, true);
+    }
+}
+
+void FillSimulator::on_book(double ts, const L2Book& book) {
+    if (!resting_) return;
+    double eps = kPriceEps * rest_price_;
+    if (rest_side_ > 0) {
+        if (book.ask_levels() > 0 && book.best_ask() <= rest_price_ + eps) {
+            resting_ = false;
+            fill(rest_, rest_side_, ts, rest_price_, true);
+            return;
+        }
+        if (book.bid_levels() > 0) rest_ahead_ = std::min(rest_ahead_, book.bid_size_at(rest_price_));
+    } else {
+        if (book.bid_levels() > 0 && book.best_bid() >= rest_price_ - eps) {
+            resting_ = false;
+            fill(rest_, rest_side_, ts, rest_price_, true);
+            return;
+        }
+        if (book.ask_levels() > 0) rest_ahead_ = std::min(rest_ahead_, book.ask_size_at(rest_price_));
+    }
+}
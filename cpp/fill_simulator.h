@@ -0,0 +1,135 @@
+// cpp/fill_simulator.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "l2_book.h"
+#include "mean_reversion_strategy.h"
+#include "sweep_model.h"
+
+enum class OrderStyle : int32_t {
+    Market = 0,  // 到达时按盘口逐档吃单（taker）
+    Limit  = 1   // 到达时挂在己方最优价排队（maker）；超时后开仓单撤单、平仓单改市价
+};
+
+enum class LatencyDist : int32_t {
+    Fixed       = 0,  // latency_ms
+    Uniform     = 1,  // latency_ms + U[0, jitter_ms)
+    Exponential = 2,  // latency_ms + 指数分布（均值 jitter_ms）
+    Empirical   = 3   // latency_ms + 从 latency_samples_ms 等概率抽取（如实盘测得的延迟）
+};
+
+// 成交模拟参数；默认为零延迟、零费率、市价单
+struct FillModel {
+    double order_qty = 1.0;          // 每笔下单量，与盘口 size / 成交 volume 同单位
+    OrderStyle entry = OrderStyle::Market;
+    OrderStyle exit = OrderStyle::Market;
+    double limit_timeout_sec = 1.0;  // 限价单从挂上到超时的时间
+
+    // 策略动作（act.ts，已含策略自己的 delay_ms）到订单到达交易所的时间
+    LatencyDist latency = LatencyDist::Fixed;
+    double latency_ms = 0.0;
+    double jitter_ms = 0.0;
+    std::vector<double> latency_samples_ms;
+    uint64_t seed = 1;               // 同一 seed 抽到的延迟序列相同：网格里各组参数面对同样的延迟
+
+    double taker_fee_bp = 0.0;       // 按成交额每边收取，负数为返佣
+    double maker_fee_bp = 0.0;
+
+    double tick_size = 0.01;         // 回测自己维护盘口时 L2Book 的 tick
+};
+
+// 一次模拟成交（整笔成交，不拆部分成交）
+struct SimFill {
+    double  ts;            // 成交时间：市价单为到达时间，限价单为成交的那笔 trade
+    double  price;         // 成交均价
+    double  signal_price;  // 策略动作的价格
+    double  fee_bp;
+    int32_t dir;           // 持仓方向（开仓 / 被平掉的仓位）
+    uint8_t entry;         // 1=开仓，0=平仓
+    uint8_t maker;         // 1=限价单排队成交
+};
+
+struct FillStats {
+    int64_t orders = 0;
+    int64_t market_fills = 0;
+    int64_t limit_fills = 0;
+    int64_t missed_entries = 0;   // 限价开仓超时撤单 / 被平仓信号撤掉，之后的平仓信号忽略
+    int64_t limit_to_market = 0;  // 限价平仓超时改市价
+    double  slippage_bp = 0.0;    // 成交价相对策略价格的不利偏移之和（bp，正数为吃亏）
+    double  fees_bp = 0.0;
+    double  latency_ms = 0.0;     // 抽到的延迟之和
+};
+
+// === 策略动作 -> 模拟成交：网络延迟、市价单逐档滑点、限价单排队位置、手续费 ===
+// 盘口不归本类所有，由驱动方（Backtester / ParamGrid）回放后在每次调用时传入，
+// 一份盘口可以同时服务多组参数。盘口为空（只有成交数据）时市价单按最新成交价成交，
+// 限价单排队量按 0 计
+// 驱动方按事件时间调用：
+//   advance_to(ts, book)：应用 ts 时刻的事件之前，处理到达时间 <= ts 的订单和到点的限价单
+//   on_trade / on_book：事件应用之后，更新挂单的排队位置，可能成交（盘口对手价穿过挂单价也算成交）
+//   submit(act)：策略在事件之后产生的动作
+// 排队模型：挂单时排在该价位现有挂单量之后；该价位上对手方主动成交的量先消耗前面的队列，
+// 累计超过 前面的量 + 自己的量 时整笔成交；成交价穿过挂单价直接成交；
+// 价位挂单量减少（撤单）时前面的队列不超过剩余量
+// 与 MeanReversionStrategy 一样单仓位；订单按提交顺序到达（后一单到达不早于前一单），
+// 到达时还有持仓 / 挂单的开仓单不成交（计 missed_entries），没有持仓的平仓单忽略
+// 参数不合法抛 std::invalid_argument
+class FillSimulator {
+public:
+    explicit FillSimulator(const FillModel& model = FillModel());
+
+    void advance_to(double ts, const L2Book& book);
+    void on_trade(double ts, double price, double volume, Side side);
+    void on_book(double ts, const L2Book& book);
+    void submit(const StrategyAction& act);
+
+    // 没有在途订单和挂单：驱动方可跳过 advance_to / on_book
+    bool idle() const { return head_ == pending_.size() && !resting_; }
+
+    // 新产生的成交，调用方处理后 clear_fills()
+    const std::vector<SimFill>& fills() const { return fills_; }
+    void clear_fills() { fills_.clear(); }
+
+    const FillStats& stats() const { return stats_; }
+    const FillModel& model() const { return model_; }
+    int position() const { return pos_dir_; }  // 已成交的持仓方向
+
+private:
+    struct Order {
+        double arrival;
+        double signal_price;
+        int    dir;    // 开仓单：持仓方向；平仓单不用
+        bool   entry;
+    };
+
+    FillModel model_;
+    std::mt19937_64 rng_;
+
+    std::vector<Order> pending_;  // 在途订单，按到达时间先后
+    std::size_t head_ = 0;
+    double last_arrival_ = 0.0;
+
+    // 挂单（同一时刻最多一张）
+    bool   resting_ = false;
+    Order  rest_{};
+    int    rest_side_ = 0;       // +1 买、-1 卖
+    double rest_price_ = 0.0;
+    double rest_ahead_ = 0.0;    // 排在前面的量（减到 -order_qty 时成交）
+    double rest_deadline_ = 0.0;
+
+    int    pos_dir_ = 0;
+    double last_price_ = 0.0;    // 最新成交价（盘口为空时的市价成交价）
+
+    std::vector<SimFill> fills_;
+    FillStats stats_;
+
+    double sample_latency_sec();
+    void execute(const Order& o, double ts, const L2Book& book);
+    void place_limit(const Order& o, int side, double ts, const L2Book& book);
+    void fill_market(const Order& o, int side, double ts, const L2Book& book);
+    void fill(const Order& o, int side, double ts, double price, bool maker);
+    void expire(const L2Book& book);
+};
@@ -0,0 +1,125 @@
+// cpp/json_scan.h
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+#include "fast_parse.h"
+
+// 轻量 JSON 扫描器：单遍、只前进、不分配
+// 只覆盖行情消息用到的部分：对象 / 数组遍历、字符串原文（不反转义）、数字、跳过任意值
+// 出错时返回 false，调用方丢弃整条消息即可
+class JsonScanner {
+public:
+    JsonScanner(const char* data, std::size_t len) : p_(data), end_(data + len) {}
+
+    const char* pos() const { return p_; }
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+
+    // 下一个非空白字符（到末尾返回 0）
+    char peek() {
+        skip_ws();
+        return p_ < end_ ? *p_ : '\0';
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++p_;
+        return true;
+    }
+
+    // 读字符串，out 指向引号内的原文（含转义序列原样）
+    bool read_string(std::string_view& out) {
+        if (!consume('"')) return false;
+        const char* start = p_;
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ == '\\') ++p_;  // 跳过被转义的字符
+            ++p_;
+        }
+        if (p_ >= end_) return false;
+        out = std::string_view(start, static_cast<std::size_t>(p_ - start));
+        ++p_;
+        return true;
+    }
+
+    // 数字：裸数字或字符串内的数字（Bybit 价格 / 数量都是字符串）
+    bool read_number(double& out) {
+        if (peek() == '"') {
+            std::string_view s;
+            return read_string(s) && parse_double(s.data(), s.size(), out);
+        }
+        const char* start = p_;
+        while (p_ < end_ && is_number_char(*p_)) ++p_;
+        return p_ != start && parse_double(start, p_, out);
+    }
+
+    // 遍历对象：每个成员调用 fn(key)，fn 必须恰好消费该 key 的值
+    template <typename Fn>
+    bool for_each_member(Fn&& fn) {
+        if (!consume('{')) return false;
+        if (consume('}')) return true;
+        for (;;) {
+            std::string_view key;
+            if (!read_string(key) || !consume(':')) return false;
+            if (!fn(key)) return false;
+            if (consume(',')) continue;
+            return consume('}');
+        }
+    }
+
+    // 遍历数组：每个元素调用 fn()，fn 必须恰好消费一个元素
+    template <typename Fn>
+    bool for_each_element(Fn&& fn) {
+        if (!consume('[')) return false;
+        if (consume(']')) return true;
+        for (;;) {
+            if (!fn()) return false;
+            if (consume(',')) continue;
+            return consume(']');
+        }
+    }
+
+    // 跳过任意值（字符串内的括号不计）
+    bool skip_value() {
+        char c = peek();
+        if (c == '"') {
+            std::string_view s;
+            return read_string(s);
+        }
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while (p_ < end_) {
+                char ch = *p_;
+                if (ch == '"') {
+                    std::string_view s;
+                    if (!read_string(s)) return false;
+                    continue;
+                }
+                ++p_;
+                if (ch == '{' || ch == '[') {
+                    ++depth;
+                } else if (ch == '}' || ch == ']') {
+                    if (--depth == 0) return true;
+                }
+            }
+            return false;
+        }
+        // 数字 / true / false / null
+        const char* start = p_;
+        while (p_ < end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' &&
+               *p_ != ' ' && *p_ != '\n' && *p_ != '\r' && *p_ != '\t') {
+            ++p_;
+        }
+        return p_ != start;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+
+    static bool is_number_char(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+};
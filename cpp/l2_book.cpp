@@ -0,0 +1,326 @@
+// cpp/l2_book.cpp
+#include "l2_book.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "state_io.h"
+
+namespace {
+// 价格换算 tick 时的容差（价格本身是 tick_size 的整数倍，只防浮点误差）
+constexpr double kTickEps = 1e-9;
+// 区间外扩时的最小余量（档）
+constexpr int64_t kMinGrow = 256;
+// tick 的绝对值上限：远小于 int64，区间运算不会溢出
+constexpr double kMaxTick = 1e15;
+}  // namespace
+
+// ---------------- BookSide ----------------
+
+void L2Book::BookSide::clear() {
+    // 保留 capacity：下一次 snapshot 重新定位区间时不分配
+    sizes_.clear();
+    tree_.clear();
+    lo_ = 0;
+    levels_ = 0;
+    best_ = 0;
+}
+
+bool L2Book::BookSide::ensure_range(int64_t tick) {
+    if (in_range(tick)) return true;
+    if (levels_ == 0) {
+        // 空边：围绕新档位重新定位（保留 capacity）
+        sizes_.assign(static_cast<std::size_t>(2 * kMinGrow), 0.0);
+        tree_.assign(sizes_.size() + 1, 0.0);
+        lo_ = tick - kMinGrow;
+        return true;
+    }
+
+    int64_t size = static_cast<int64_t>(sizes_.size());
+    int64_t grow = std::max(kMinGrow, size / 2);
+    int64_t new_lo = tick < lo_ ? tick - grow : lo_;
+    int64_t new_hi = tick < lo_ ? lo_ + size : tick + 1 + grow;  // 不含
+    if (new_hi - new_lo > static_cast<int64_t>(kMaxSpan)) {
+        // 超过上限：只保留有挂单的档位 [occ_lo, occ_hi]，加上新档位还放不下则拒收
+        int64_t occ_lo = lo_ + size, occ_hi = lo_ - 1;
+        for (int64_t i = 0; i < size; ++i) {
+            if (sizes_[static_cast<std::size_t>(i)] > 0.0) {
+                occ_lo = std::min(occ_lo, lo_ + i);
+                occ_hi = std::max(occ_hi, lo_ + i);
+            }
+        }
+        occ_lo = std::min(occ_lo, tick);
+        occ_hi = std::max(occ_hi, tick);
+        int64_t need = occ_hi - occ_lo + 1;
+        if (need > static_cast<int64_t>(kMaxSpan)) return false;
+        int64_t span = std::min(static_cast<int64_t>(kMaxSpan), need + 2 * grow);
+        new_lo = occ_lo - (span - need) / 2;
+        new_hi = new_lo + span;
+    }
+    relocate(new_lo, static_cast<std::size_t>(new_hi - new_lo));
+    return true;
+}
+
+// 数组改为覆盖 [lo, lo + size)；调用方保证所有非空档都在新区间内
+void L2Book::BookSide::relocate(int64_t lo, std::size_t size) {
+    std::vector<double> next(size, 0.0);
+    int64_t old_size = static_cast<int64_t>(sizes_.size());
+    for (int64_t i = 0; i < old_size; ++i) {
+        double v = sizes_[static_cast<std::size_t>(i)];
+        if (v > 0.0) next[static_cast<std::size_t>(lo_ + i - lo)] = v;
+    }
+    sizes_.swap(next);
+    lo_ = lo;
+    // 下标整体平移，Fenwick 树重建（只在区间外扩时发生）
+    rebuild_tree();
+}
+
+void L2Book::BookSide::rebuild_tree() {
+    std::size_t n = sizes_.size();
+    tree_.assign(n + 1, 0.0);
+    for (std::size_t i = 1; i <= n; ++i) {
+        tree_[i] += sizes_[i - 1];
+        std::size_t parent = i + (i & (~i + 1));
+        if (parent <= n) tree_[parent] += tree_[i];
+    }
+}
+
+void L2Book::BookSide::tree_add(std::size_t idx, double delta) {
+    for (std::size_t i = idx + 1; i < tree_.size(); i += i & (~i + 1)) {
+        tree_[i] += delta;
+    }
+}
+
+double L2Book::BookSide::prefix(int64_t idx) const {
+    double sum = 0.0;
+    for (std::size_t i = static_cast<std::size_t>(idx + 1); i > 0; i -= i & (~i + 1)) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+void L2Book::BookSide::rescan_best() {
+    if (levels_ == 0) {
+        best_ = 0;
+        return;
+    }
+    // 从旧的最优档向内找下一个非空档
+    int64_t hi = lo_ + static_cast<int64_t>(sizes_.size());
+    for (int64_t t = best_; t >= lo_ && t < hi; t -= dir_) {
+        if (sizes_[static_cast<std::size_t>(t - lo_)] > 0.0) {
+            best_ = t;
+            return;
+        }
+    }
+}
+
+bool L2Book::BookSide::set(int64_t tick, double size) {
+    if (size <= 0.0) {
+        if (!in_range(tick)) return true;
+        double& slot = sizes_[static_cast<std::size_t>(tick - lo_)];
+        if (slot <= 0.0) return true;
+        tree_add(static_cast<std::size_t>(tick - lo_), -slot);
+        slot = 0.0;
+        --levels_;
+        if (tick == best_) rescan_best();
+        return true;
+    }
+
+    if (!ensure_range(tick)) return false;
+    std::size_t idx = static_cast<std::size_t>(tick - lo_);
+    double& slot = sizes_[idx];
+    if (slot <= 0.0) {
+        if (levels_ == 0 || better(tick, best_)) best_ = tick;
+        ++levels_;
+    }
+    tree_add(idx, size - slot);
+    slot = size;
+    return true;
+}
+
+double L2Book::BookSide::size_at(int64_t tick) const {
+    if (!in_range(tick)) return 0.0;
+    return sizes_[static_cast<std::size_t>(tick - lo_)];
+}
+
+double L2Book::BookSide::depth_to(int64_t bound) const {
+    if (levels_ == 0 || better(bound, best_)) return 0.0;
+    int64_t hi = lo_ + static_cast<int64_t>(sizes_.size()) - 1;
+    int64_t a = std::min(best_, bound);
+    int64_t b = std::max(best_, bound);
+    a = std::max(a, lo_);
+    b = std::min(b, hi);
+    double sum = prefix(b - lo_) - prefix(a - lo_ - 1);
+    // 加减累积的浮点误差不让深度变成负数
+    return sum > 0.0 ? sum : 0.0;
+}
+
+double L2Book::BookSide::walk(double qty) const {
+    if (levels_ == 0) return 0.0;
+    int64_t hi = lo_ + static_cast<int64_t>(sizes_.size());
+    double cost = 0.0;
+    double left = qty;
+    int64_t last = best_;
+    for (int64_t t = best_; t >= lo_ && t < hi && left > 0.0; t -= dir_) {
+        double size = sizes_[static_cast<std::size_t>(t - lo_)];
+        if (size <= 0.0) continue;
+        double take = std::min(size, left);
+        cost += static_cast<double>(t) * take;
+        left -= take;
+        last = t;
+    }
+    return cost + static_cast<double>(last) * left;
+}
+
+void L2Book::BookSide::save_state(StateWriter& w) const {
+    w.put(lo_);
+    w.put(static_cast<uint64_t>(levels_));
+    w.put(best_);
+    w.put_vector(sizes_);
+    w.put_vector(tree_);
+}
+
+void L2Book::BookSide::load_state(StateReader& r) {
+    int64_t lo = r.get<int64_t>();
+    std::size_t levels = static_cast<std::size_t>(r.get<uint64_t>());
+    int64_t best = r.get<int64_t>();
+    std::vector<double> sizes, tree;
+    r.get_vector(sizes);
+    r.get_vector(tree);
+
+    // levels_ / best_ 须与数组一致：非空档数 == levels，best 为最优的非空档
+    bool ok = tree.size() == (sizes.empty() ? 0 : sizes.size() + 1) && sizes.size() <= kMaxSpan &&
+              std::fabs(static_cast<double>(lo)) < kMaxTick;
+    std::size_t count = 0;
+    int64_t found = 0;
+    for (std::size_t i = 0; ok && i < sizes.size(); ++i) {
+        double v = sizes[i];
+        if (!(v >= 0.0) || std::isinf(v)) ok = false;  // 负数 / NaN / inf
+        if (v > 0.0) {
+            int64_t t = lo + static_cast<int64_t>(i);
+            if (count == 0 || better(t, found)) found = t;
+            ++count;
+        }
+    }
+    if (!ok || count != levels || (levels > 0 && best != found)) {
+        throw std::runtime_error("state: corrupt L2 book side");
+    }
+
+    lo_ = lo;
+    levels_ = levels;
+    best_ = levels > 0 ? best : 0;
+    sizes_ = std::move(sizes);
+    tree_ = std::move(tree);
+}
+
+// ---------------- L2Book ----------------
+
+L2Book::L2Book(double tick_size) : tick_size_(tick_size) {}
+
+bool L2Book::to_tick(double price, int64_t& tick) const {
+    double t = price / tick_size_;
+    if (!(price > 0.0) || !(t < kMaxTick)) return false;  // NaN / inf / <= 0 都不通过
+    tick = static_cast<int64_t>(std::llround(t));
+    return true;
+}
+
+void L2Book::apply_bid(double price, double size) {
+    int64_t tick;
+    if (!to_tick(price, tick) || !std::isfinite(size) || !bids_.set(tick, size)) ++rejected_;
+}
+
+void L2Book::apply_ask(double price, double size) {
+    int64_t tick;
+    if (!to_tick(price, tick) || !std::isfinite(size) || !asks_.set(tick, size)) ++rejected_;
+}
+
+void L2Book::apply_bids(const double* levels, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        apply_bid(levels[2 * i], levels[2 * i + 1]);
+    }
+}
+
+void L2Book::apply_asks(const double* levels, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        apply_ask(levels[2 * i], levels[2 * i + 1]);
+    }
+}
+
+void L2Book::apply_snapshot(const std::vector<std::pair<double, double>>& bids,
+                            const std::vector<std::pair<double, double>>& asks) {
+    clear();
+    apply_delta(bids, asks);
+}
+
+void L2Book::apply_delta(const std::vector<std::pair<double, double>>& bids,
+                         const std::vector<std::pair<double, double>>& asks) {
+    for (const auto& kv : bids) apply_bid(kv.first, kv.second);
+    for (const auto& kv : asks) apply_ask(kv.first, kv.second);
+}
+
+void L2Book::save_state(StateWriter& w) const {
+    w.put(tick_size_);
+    bids_.save_state(w);
+    asks_.save_state(w);
+}
+
+void L2Book::load_state(StateReader& r) {
+    double tick_size = r.get<double>();
+    if (!(tick_size > 0.0) || std::isinf(tick_size)) throw std::runtime_error("state: corrupt L2 book");
+    // 两边都校验通过才覆盖
+    BookSide bids(+1), asks(-1);
+    bids.load_state(r);
+    asks.load_state(r);
+    tick_size_ = tick_size;
+    bids_ = std::move(bids);
+    asks_ = std::move(asks);
+}
+
+void L2Book::clear() {
+    bids_.clear();
+    asks_.clear();
+}
+
+double L2Book::best_bid() const {
+    return bids_.empty() ? 0.0 : to_price(bids_.best());
+}
+
+double L2Book::best_ask() const {
+    return asks_.empty() ? 0.0 : to_price(asks_.best());
+}
+
+double L2Book::bid_size_at(double price) const {
+    int64_t tick;
+    return to_tick(price, tick) ? bids_.size_at(tick) : 0.0;
+}
+
+double L2Book::ask_size_at(double price) const {
+    int64_t tick;
+    return to_tick(price, tick) ? asks_.size_at(tick) : 0.0;
+}
+
+std::pair<double, double> L2Book::depth_within(double mid, double pct) const {
+    double lower = mid * (1.0 - pct) / tick_size_;
+    double upper = mid * (1.0 + pct) / tick_size_;
+    // bid: tick*tick_size >= lower；ask: tick*tick_size < upper
+    int64_t bid_bound = static_cast<int64_t>(std::ceil(lower - kTickEps));
+    int64_t ask_bound = static_cast<int64_t>(std::ceil(upper - kTickEps)) - 1;
+    return {bids_.depth_to(bid_bound), asks_.depth_to(ask_bound)};
+}
+
+void L2Book::depth_bands(double mid, const double* bands_bp, std::size_t n,
+                         double* bid_out, double* ask_out) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        auto d = depth_within(mid, bands_bp[i] / 10000.0);
+        bid_out[i] = d.first;
+        ask_out[i] = d.second;
+    }
+}
+
+double L2Book::market_price(int dir, double qty) const {
+    const BookSide& side = dir > 0 ? asks_ : bids_;
+    if (side.empty() || !(qty > 0.0)) return side.empty() ? 0.0 : to_price(side.best());
+    return side.walk(qty) / qty * tick_size_;
+}
@@ -0,0 +1,125 @@
+// cpp/l2_book.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class StateWriter;
+class StateReader;
+
+// === 扁平 L2 订单簿：按整数 tick（price / tick_size）索引的连续数组 ===
+// - 价格先取整成 tick，避免 double key 比较 / 删除的精度问题
+// - 增删改档位 O(1)，只有价格区间外扩时才会分配
+// - 每边区间最多 kMaxSpan 档：超出时按仍有挂单的档位重新定位，仍放不下的档位拒收；
+//   非有限 / 非正价格同样拒收，都计入 rejected_levels()
+// - best_bid / best_ask O(1)；最优档被删时向内扫描到下一个非空档
+// - 每边维护 Fenwick 树（按 tick 的前缀和），任意深度档位只需两次 O(log n) 查询
+class L2Book {
+public:
+    explicit L2Book(double tick_size = 0.01);
+
+    // 单边数组最多覆盖的 tick 数（含 Fenwick 树约 16 MB）
+    static constexpr std::size_t kMaxSpan = std::size_t(1) << 20;
+
+    // size<=0 表示删除该档
+    void apply_bid(double price, double size);
+    void apply_ask(double price, double size);
+
+    // levels 为 n 行 (price, size) 的行主序数组（N×2 float64）
+    void apply_bids(const double* levels, std::size_t n);
+    void apply_asks(const double* levels, std::size_t n);
+
+    void apply_snapshot(const std::vector<std::pair<double, double>>& bids,
+                        const std::vector<std::pair<double, double>>& asks);
+    void apply_delta(const std::vector<std::pair<double, double>>& bids,
+                     const std::vector<std::pair<double, double>>& asks);
+
+    void clear();
+
+    // 空簿返回 0
+    double best_bid() const;
+    double best_ask() const;
+
+    double bid_size_at(double price) const;
+    double ask_size_at(double price) const;
+
+    std::size_t bid_levels() const { return bids_.levels(); }
+    std::size_t ask_levels() const { return asks_.levels(); }
+
+    double tick_size() const { return tick_size_; }
+
+    // 被拒收的档位数（坏价格 / 超出 kMaxSpan），累计值，clear 不清零、不进快照
+    uint64_t rejected_levels() const { return rejected_; }
+
+    // mid*(1-pct) <= bid 价格；ask 价格 < mid*(1+pct)；返回 (bid 深度, ask 深度)
+    std::pair<double, double> depth_within(double mid, double pct) const;
+
+    // 一次查询多个深度档（单位 bp，如 5/10/25/50），bid_out / ask_out 各写 n 个
+    void depth_bands(double mid, const double* bands_bp, std::size_t n,
+                     double* bid_out, double* ask_out) const;
+
+    // 市价单从最优档逐档吃掉 qty 的成交均价：dir>0 买（吃 ask），dir<0 卖（吃 bid）
+    // 盘口量不够时剩余部分按最后一档的价格计；该侧为空返回 0
+    double market_price(int dir, double qty) const;
+
+    // 状态快照：两侧数组原样写出（含 Fenwick 树），恢复后深度查询逐位一致
+    // 恢复时校验档位数 / 最优档与数组一致，不一致抛 std::runtime_error，簿保持原状
+    void save_state(StateWriter& w) const;
+    void load_state(StateReader& r);
+
+private:
+    // 单边：sizes_[i] 为 tick = lo_ + i 的挂单量（0 表示空档）
+    // dir_ = +1 表示 bid（tick 越大越优），-1 表示 ask（tick 越小越优）
+    class BookSide {
+    public:
+        explicit BookSide(int dir) : dir_(dir) {}
+
+        // 档位放不进 kMaxSpan 区间时返回 false，不做修改
+        bool set(int64_t tick, double size);
+        void clear();
+
+        bool empty() const { return levels_ == 0; }
+        std::size_t levels() const { return levels_; }
+        int64_t best() const { return best_; }
+        double size_at(int64_t tick) const;
+
+        // 从最优档到 bound（含）的挂单量之和；bound 落在最优档之外时返回 0
+        double depth_to(int64_t bound) const;
+
+        // 从最优档向外吃掉 qty：返回 Σ tick * 量（剩余部分按最后一档计），空时返回 0
+        double walk(double qty) const;
+
+        void save_state(StateWriter& w) const;
+        void load_state(StateReader& r);
+
+    private:
+        int dir_;
+        int64_t lo_ = 0;
+        std::vector<double> sizes_;
+        std::vector<double> tree_;  // Fenwick 树，1-based，tree_.size() == sizes_.size() + 1
+        std::size_t levels_ = 0;
+        int64_t best_ = 0;
+
+        bool in_range(int64_t tick) const {
+            return tick >= lo_ && tick < lo_ + static_cast<int64_t>(sizes_.size());
+        }
+        bool better(int64_t a, int64_t b) const { return dir_ > 0 ? a > b : a < b; }
+        bool ensure_range(int64_t tick);
+        void relocate(int64_t lo, std::size_t size);
+        void rescan_best();
+
+        void tree_add(std::size_t idx, double delta);
+        double prefix(int64_t idx) const;  // sizes_[0..idx] 之和，idx<0 时为 0
+        void rebuild_tree();
+    };
+
+    double tick_size_;
+    BookSide bids_{+1};
+    BookSide asks_{-1};
+    uint64_t rejected_ = 0;
+
+    // 价格非有限、非正或超出 int64 tick 范围时返回 false
+    bool to_tick(double price, int64_t& tick) const;
+    double to_price(int64_t tick) const { return static_cast<double>(tick) * tick_size_; }
+};
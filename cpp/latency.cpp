@@ -0,0 +1,105 @@
+// cpp/latency.cpp
+#include "latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+const char* latency_stage_name(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::ProcessTick:        return "process_tick";
+    case LatencyStage::OnSweep:            return "on_sweep";
+    case LatencyStage::OnTick:             return "on_tick";
+    case LatencyStage::AddTrade:           return "add_trade";
+    case LatencyStage::ApplyL2Snapshot:    return "apply_l2_snapshot";
+    case LatencyStage::ApplyL2Delta:       return "apply_l2_delta";
+    case LatencyStage::GetFrame:           return "get_frame";
+    case LatencyStage::ExchangeToDecision: return "exchange_to_decision";
+    case LatencyStage::Count:              break;
+    }
+    return "unknown";
+}
+
+uint64_t LatencyHistogram::bucket_value(std::size_t idx) {
+    if (idx < kSubCount) return idx;
+    int e = static_cast<int>(idx / kSubCount) + kSubBits - 1;
+    uint64_t sub = idx % kSubCount;
+    uint64_t lo = (kSubCount + sub) << (e - kSubBits);
+    uint64_t width = uint64_t(1) << (e - kSubBits);
+    return lo + width / 2;
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const {
+    uint64_t counts[kBuckets];
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    LatencySnapshot s;
+    s.count = total;
+    if (total == 0) return s;
+    s.mean_ns = static_cast<double>(sum_.load(std::memory_order_relaxed)) / total;
+    s.max_ns = max_.load(std::memory_order_relaxed);
+
+    // 第 ceil(q * total) 个样本所在的桶；代表值不超过观测到的最大值
+    auto quantile = [&](double q) {
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(bucket_value(i), s.max_ns);
+        }
+        return s.max_ns;
+    };
+    s.p50_ns = quantile(0.50);
+    s.p99_ns = quantile(0.99);
+    s.p999_ns = quantile(0.999);
+    return s;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void reset_latency() {
+    for (auto& h : latency_histograms) h.reset();
+}
+
+void record_exchange_latency(double exchange_ts_sec) {
+    double now = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    double ns = (now - exchange_ts_sec) * 1e9;
+    latency_histogram(LatencyStage::ExchangeToDecision)
+        .record(ns > 0.0 ? static_cast<uint64_t>(ns) : 0);
+}
+
+#if defined(SWEEP_LATENCY_TSC) && (defined(__x86_64__) || defined(__i386__))
+double latency_tsc_ns_per_tick() {
+    // 对 steady_clock 标定 20ms；假定 invariant TSC（近代 x86 都是）
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto t1 = std::chrono::steady_clock::now();
+    uint64_t c1 = __rdtsc();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    return c1 > c0 ? ns / static_cast<double>(c1 - c0) : 1.0;
+}
+
+std::atomic<double> latency_ns_per_tick{1.0};
+
+void latency_calibrate() {
+    latency_ns_per_tick.store(latency_tsc_ns_per_tick(), std::memory_order_relaxed);
+}
+
+namespace {
+// 启动时标定：第一次计时不会落在 20ms 的标定上
+const bool kTscCalibrated = (latency_calibrate(), true);
+}  // namespace
+#else
+void latency_calibrate() {}
+#endif
@@ -0,0 +1,139 @@
+// cpp/latency.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(SWEEP_LATENCY_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+// === 热路径延迟统计 ===
+// 编译时定义 SWEEP_LATENCY=1（CMake: -DSWEEP_LATENCY=ON）才会计时；
+// 否则 SWEEP_LATENCY_SCOPE / SWEEP_LATENCY_EXCHANGE 展开为空，热路径里什么都不剩
+// 计时默认用 steady_clock；再定义 SWEEP_LATENCY_TSC 则用 rdtsc（启动时对 steady_clock 标定一次）
+// 直方图是进程级的（每个阶段一个），多线程可以同时写，Python 随时取快照
+
+enum class LatencyStage : uint8_t {
+    ProcessTick = 0,     // SweepModel::process_tick
+    OnSweep,             // MeanReversionStrategy::on_sweep
+    OnTick,              // MeanReversionStrategy::on_tick
+    AddTrade,            // OrderFlowFeatureExtractor::add_trade
+    ApplyL2Snapshot,     // OrderFlowFeatureExtractor::apply_l2_snapshot
+    ApplyL2Delta,        // OrderFlowFeatureExtractor::apply_l2_delta
+    GetFrame,            // OrderFlowFeatureExtractor::get_frame
+    ExchangeToDecision,  // 成交的交易所时间 -> 本地完成 on_tick（墙钟，含网络）
+    Count
+};
+
+constexpr std::size_t kNumLatencyStages = static_cast<std::size_t>(LatencyStage::Count);
+
+const char* latency_stage_name(LatencyStage stage);
+
+struct LatencySnapshot {
+    uint64_t count = 0;
+    double   mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// HDR 式对数-线性分桶：每个 2 的幂区间再等分 32 份，相对误差 < 3.2%，覆盖到 2^40 ns
+// 记录只有几次 relaxed 原子加，无锁；快照是近似一致的（记录中的几次可能只计入一部分）
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr uint64_t kSubCount = uint64_t(1) << kSubBits;
+    static constexpr int kMaxExp = 40;
+    static constexpr std::size_t kBuckets = (kMaxExp - kSubBits + 1) * kSubCount + kSubCount;
+
+    void record(uint64_t ns) {
+        buckets_[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t cur = max_.load(std::memory_order_relaxed);
+        while (ns > cur && !max_.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    LatencySnapshot snapshot() const;
+    void reset();
+
+    static std::size_t bucket_of(uint64_t v) {
+        if (v < kSubCount) return static_cast<std::size_t>(v);
+        int e = 63 - __builtin_clzll(v);
+        if (e > kMaxExp) return kBuckets - 1;
+        uint64_t sub = (v >> (e - kSubBits)) & (kSubCount - 1);
+        return static_cast<std::size_t>((e - kSubBits + 1) * kSubCount + sub);
+    }
+
+    // 桶的代表值（区间中点）
+    static uint64_t bucket_value(std::size_t idx);
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// 进程级，每个阶段一个
+inline LatencyHistogram latency_histograms[kNumLatencyStages];
+
+inline LatencyHistogram& latency_histogram(LatencyStage stage) {
+    return latency_histograms[static_cast<std::size_t>(stage)];
+}
+
+void reset_latency();
+
+// TSC 计时时对 steady_clock 重新标定（阻塞约 20ms）；进程启动时已自动标定一次，
+// 计时路径只读标定结果。steady_clock 计时时什么都不做
+void latency_calibrate();
+
+#if defined(SWEEP_LATENCY_TSC) && (defined(__x86_64__) || defined(__i386__))
+double latency_tsc_ns_per_tick();
+
+// 每个 TSC 周期的纳秒数，latency_calibrate() 写入（latency.cpp 静态初始化时调用一次）
+extern std::atomic<double> latency_ns_per_tick;
+
+inline uint64_t latency_now_ns() {
+    double ns_per_tick = latency_ns_per_tick.load(std::memory_order_relaxed);
+    return static_cast<uint64_t>(static_cast<double>(__rdtsc()) * ns_per_tick);
+}
+#else
+inline uint64_t latency_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+// 作用域计时：构造到析构的耗时记入对应阶段
+class LatencyTimer {
+public:
+    explicit LatencyTimer(LatencyStage stage) : stage_(stage), start_(latency_now_ns()) {}
+    ~LatencyTimer() { latency_histogram(stage_).record(latency_now_ns() - start_); }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+private:
+    LatencyStage stage_;
+    uint64_t start_;
+};
+
+// 交易所时间戳（秒，epoch）到现在的墙钟延迟；本地时钟偏差导致的负值记为 0
+void record_exchange_latency(double exchange_ts_sec);
+
+#define SWEEP_LATENCY_CONCAT_(a, b) a##b
+#define SWEEP_LATENCY_CONCAT(a, b) SWEEP_LATENCY_CONCAT_(a, b)
+
+#if SWEEP_LATENCY
+#define SWEEP_LATENCY_SCOPE(stage) \
+    LatencyTimer SWEEP_LATENCY_CONCAT(latency_timer_, __LINE__)(LatencyStage::stage)
+#define SWEEP_LATENCY_EXCHANGE(ts) record_exchange_latency(ts)
+constexpr bool kLatencyEnabled = true;
+#else
+#define SWEEP_LATENCY_SCOPE(stage) ((void)0)
+#define SWEEP_LATENCY_EXCHANGE(ts) ((void)0)
+constexpr bool kLatencyEnabled = false;
+#endif
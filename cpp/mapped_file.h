@@ -0,0 +1,66 @@
+// cpp/mapped_file.h
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 只读 mmap 整个文件（RAII）；空文件 data() 为 nullptr、size() 为 0
+// 打开失败抛 std::runtime_error
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) fail("cannot open", path);
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            ::close(fd_);
+            fail("cannot stat", path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) return;
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd_);
+            fail("cannot mmap", path);
+        }
+        data_ = static_cast<const char*>(p);
+    }
+
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // 顺序读取提示 / 释放已读过的页（只影响本进程的驻留内存）
+    void advise_sequential() const {
+        if (data_) ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+    void release(const char* first, const char* last) const {
+        std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t lo = (static_cast<std::size_t>(first - data_) + page - 1) / page * page;
+        std::size_t hi = static_cast<std::size_t>(last - data_) / page * page;
+        if (hi > lo) ::madvise(const_cast<char*>(data_) + lo, hi - lo, MADV_DONTNEED);
+    }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    [[noreturn]] static void fail(const char* what, const std::string& path) {
+        throw std::runtime_error(std::string(what) + ": " + path + " (" + std::strerror(errno) + ")");
+    }
+};
@@ -0,0 +1,24 @@
+// cpp/market_queue.cpp
+#include "market_queue.h"
+
+#include <chrono>
+#include <thread>
+
+namespace {
+// 先自旋这么多次（新消息通常很快就到），之后每次 sleep 一小段
+constexpr int kSpinBeforeSleep = 1024;
+constexpr auto kSleepStep = std::chrono::microseconds(50);
+}  // namespace
+
+bool MarketQueue::wait(double timeout_sec) {
+    if (q_.front()) return true;
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(timeout_sec));
+    for (int spins = 0; !q_.front(); ++spins) {
+        if (spins < kSpinBeforeSleep) continue;
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(kSleepStep);
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+// cpp/market_queue.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "spsc_queue.h"
+
+// 行情记录类型
+enum class RecordKind : uint8_t {
+    Trade   = 0,  // 逐笔成交：ts / price / size=成交量 / side
+    Bid     = 1,  // 一档买盘：price / size（0 = 删除）
+    Ask     = 2,  // 一档卖盘
+    BookEnd = 3   // 一条盘口消息结束：之前累积的 Bid / Ask 作为一次 snapshot / delta 应用
+};
+
+// BookEnd 的 flags
+constexpr uint8_t kRecordSnapshot = 1;
+constexpr uint8_t kRecordBookGap  = 2;  // 之前有盘口消息被丢弃：清空簿，等下一条 snapshot（不带档位）
+
+// 紧凑的定长行情记录（32 字节），接收线程解析出来交给策略线程
+struct MarketRecord {
+    double     ts;     // 秒；Bid / Ask 为 0，BookEnd 为消息时间
+    double     price;
+    double     size;
+    RecordKind kind;
+    int8_t     side;   // Trade：+1=Buy, -1=Sell
+    uint8_t    flags;
+    uint8_t    pad[5];
+};
+static_assert(sizeof(MarketRecord) == 32, "MarketRecord must stay 32 bytes");
+
+// === 接收线程 -> 策略线程的行情队列（SPSC，无锁）===
+// 以消息为单位入队：一条消息的记录要么全部进去，要么整条丢弃并计数，策略线程不会看到半条盘口
+// 丢了盘口消息之后的 delta 不能再用，由 BybitRecordDecoder 标记缺口（见 kRecordBookGap）
+// 计数器任意线程可读，给监控用；每个计数器只有一个写线程（popped 归策略线程，其余归接收线程），
+// 写入用 relaxed 读 + 写，不做带 lock 前缀的 RMW
+class MarketQueue {
+public:
+    explicit MarketQueue(std::size_t capacity = 65536) : q_(capacity) {}
+
+    // ---- 接收线程 ----
+    bool push(const MarketRecord* records, std::size_t n) {
+        if (!q_.try_push_n(records, n)) {
+            bump(dropped_, static_cast<int64_t>(n));
+            bump(dropped_messages_, 1);
+            return false;
+        }
+        bump(pushed_, static_cast<int64_t>(n));
+        std::size_t d = q_.size();
+        if (d > max_depth_.load(std::memory_order_relaxed)) {
+            max_depth_.store(d, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // ---- 策略线程 ----
+    const MarketRecord* front() { return q_.front(); }
+    void pop() {
+        q_.pop();
+        bump(popped_, 1);
+    }
+
+    // 等到有记录或超时（先自旋再短暂 sleep），有记录返回 true
+    bool wait(double timeout_sec);
+
+    // ---- 监控 ----
+    std::size_t depth() const { return q_.size(); }
+    std::size_t capacity() const { return q_.capacity(); }
+    std::size_t max_depth() const { return max_depth_.load(std::memory_order_relaxed); }
+    int64_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+    int64_t popped() const { return popped_.load(std::memory_order_relaxed); }
+    int64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    int64_t dropped_messages() const { return dropped_messages_.load(std::memory_order_relaxed); }
+
+private:
+    SpscQueue<MarketRecord> q_;
+
+    std::atomic<int64_t> pushed_{0};
+    std::atomic<int64_t> popped_{0};
+    std::atomic<int64_t> dropped_{0};           // 记录数
+    std::atomic<int64_t> dropped_messages_{0};
+    std::atomic<std::size_t> max_depth_{0};
+
+    // 单写者计数：只有拥有它的线程调用
+    static void bump(std::atomic<int64_t>& c, int64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
@@ -1,6 +1,14 @@
 #include "mean_reversion_strategy.h"
 
+#include "latency.h"
+#include "state_io.h"
+
+namespace {
+constexpr char kStrategyStateMagic[5] = "MRST";
+}  // namespace
+
 StrategyAction MeanReversionStrategy::on_sweep(const SweepEventMeta& ev) {
+    SWEEP_LATENCY_SCOPE(OnSweep);
     StrategyAction act;
 
     if (in_position) {
@@ -44,6 +52,7 @@ StrategyAction MeanReversionStrategy::on_sweep(const SweepEventMeta& ev) {
 }
 
 StrategyAction MeanReversionStrategy::on_tick(double ts, double price) {
+    SWEEP_LATENCY_SCOPE(OnTick);
     StrategyAction act;
 
     if (!in_position) return act;
@@ -104,3 +113,31 @@ void MeanReversionStrategy::clear_position() {
     entry_price = 0.0;
     entry_ts = 0.0;
 }
+
+std::string MeanReversionStrategy::serialize() const {
+    StateWriter w(kStrategyStateMagic);
+    w.put(delay_ms);
+    w.put(hold_sec);
+    w.put(tp_bp);
+    w.put(sl_bp);
+    w.put(in_position);
+    w.put(pos_dir);
+    w.put(entry_price);
+    w.put(entry_ts);
+    return w.take();
+}
+
+MeanReversionStrategy MeanReversionStrategy::deserialize(const std::string& data) {
+    StateReader r(data, kStrategyStateMagic);
+    MeanReversionStrategy s;
+    s.delay_ms = r.get<double>();
+    s.hold_sec = r.get<double>();
+    s.tp_bp = r.get<double>();
+    s.sl_bp = r.get<double>();
+    s.in_position = r.get<bool>();
+    s.pos_dir = r.get<int>();
+    s.entry_price = r.get<double>();
+    s.entry_ts = r.get<double>();
+    r.finish();
+    return s;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <string>
 #include "sweep_model.h"
 
 // 行为类型：避免使用 None
@@ -45,6 +46,10 @@ public:
     StrategyAction on_sweep(const SweepEventMeta& ev);
     StrategyAction on_tick(double ts, double price);
 
+    // 状态快照（参数 + 持仓），用于热备接管 / pickle
+    std::string serialize() const;
+    static MeanReversionStrategy deserialize(const std::string& data);
+
 private:
     void clear_position();
 };
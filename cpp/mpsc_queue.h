@@ -0,0 +1,79 @@
+// cpp/mpsc_queue.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "spsc_queue.h"  // kCacheLine
+
+// === 有界无锁多生产者 / 单消费者队列（每个槽带序号，Vyukov 式）===
+// 生产端 CAS 抢 tail 下标后写槽，再用序号发布；消费端只有一个线程，head 不需要原子 RMW
+// 满时 try_push 返回 false，由调用方决定丢弃还是重试
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(std::size_t capacity = 4096) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        cells_.reset(new Cell[cap]);
+        mask_ = cap - 1;
+        for (std::size_t i = 0; i < cap; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // 任意线程
+    bool try_push(const T& v) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // 满：该槽还没被消费
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = v;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 只能由唯一的消费线程调用
+    bool try_pop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[pos & mask_];
+        if (cell.seq.load(std::memory_order_acquire) != pos + 1) return false;
+        out = cell.value;
+        cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 近似值（给监控用）
+    std::size_t size() const {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_ = 0;
+
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+};
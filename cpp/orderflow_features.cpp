@@ -1,14 +1,45 @@
 #include "orderflow_features.h"
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
-OrderFlowFeatureExtractor::OrderFlowFeatureExtractor()
-    : highlow_20s_(20.0), highlow_30s_(30.0) {}
+#include "latency.h"
+
+namespace {
+constexpr char kExtractorStateMagic[5] = "OFFX";
+}  // namespace
+
+OrderFlowFeatureExtractor::OrderFlowFeatureExtractor(double vol_win_1,
+                                                     double vol_win_2,
+                                                     double vol_win_3,
+                                                     double tick_size,
+                                                     double extreme_bucket_sec)
+    : vol_win_{{vol_win_1, 0, 0.0, 0.0},
+               {vol_win_2, 0, 0.0, 0.0},
+               {vol_win_3, 0, 0.0, 0.0}},
+      book_(tick_size),
+      highlow_({20.0, 30.0}, extreme_bucket_sec) {}
 
 void OrderFlowFeatureExtractor::prune_trades(double ts_now) {
-    double cutoff = ts_now - 10.0;  // longest window
-    while (!trades_.empty() && trades_.front().ts < cutoff) {
-        trades_.pop_front();
+    std::size_t drop = trades_.size();
+    for (VolumeWindow& w : vol_win_) {
+        while (w.begin < trades_.size() && ts_now - trades_[w.begin].ts > w.horizon) {
+            const TradePoint& t = trades_[w.begin];
+            if (t.side == Side::Buy) w.buy -= t.volume;
+            else w.sell -= t.volume;
+            ++w.begin;
+        }
+        if (w.begin == trades_.size()) {
+            // 窗口已空：清零，避免加减累积的浮点误差
+            w.buy = 0.0;
+            w.sell = 0.0;
+        }
+        drop = std::min(drop, w.begin);
+    }
+    // 所有窗口都越过的 trade 出队
+    if (drop > 0) {
+        trades_.pop_front(drop);
+        for (VolumeWindow& w : vol_win_) w.begin -= drop;
     }
     int cutoff_sec = static_cast<int>(std::floor(ts_now)) - 5;
     while (!buckets_.empty() && buckets_.front().sec < cutoff_sec) {
@@ -38,10 +69,10 @@ void OrderFlowFeatureExtractor::refresh_agg_run() {
     if (buckets_.size() < 3) return;
 
     // 取最近 3 个桶判断方向一致且净流增强
-    auto it = buckets_.rbegin();
-    AggBucket b3 = *it++;  // latest
-    AggBucket b2 = *it++;
-    AggBucket b1 = *it;
+    std::size_t n = buckets_.size();
+    AggBucket b3 = buckets_[n - 1];  // latest
+    AggBucket b2 = buckets_[n - 2];
+    AggBucket b1 = buckets_[n - 3];
 
     auto bucket_dir = [](const AggBucket& b) -> AggRunDir {
         double net = b.buy - b.sell;
@@ -68,106 +99,122 @@ void OrderFlowFeatureExtractor::refresh_agg_run() {
     }
 }
 
-double OrderFlowFeatureExtractor::best_bid() const {
-    if (bids_.empty()) return 0.0;
-    return bids_.rbegin()->first;  // max key
-}
-
-double OrderFlowFeatureExtractor::best_ask() const {
-    if (asks_.empty()) return 0.0;
-    return asks_.begin()->first;   // min key
-}
-
-void OrderFlowFeatureExtractor::apply_book_entries(
-    const std::vector<std::pair<double, double>>& bids,
-    const std::vector<std::pair<double, double>>& asks,
-    bool snapshot) {
-
-    if (snapshot) {
-        bids_.clear();
-        asks_.clear();
-    }
-    for (const auto& kv : bids) {
-        double px = kv.first;
-        double sz = kv.second;
-        if (sz <= 0.0) {
-            bids_.erase(px);
-        } else {
-            bids_[px] = sz;
-        }
-    }
-    for (const auto& kv : asks) {
-        double px = kv.first;
-        double sz = kv.second;
-        if (sz <= 0.0) {
-            asks_.erase(px);
-        } else {
-            asks_[px] = sz;
-        }
-    }
-}
-
-std::pair<double, double> OrderFlowFeatureExtractor::depth_within(double mid, double pct) const {
-    double lower = mid * (1.0 - pct);
-    double upper = mid * (1.0 + pct);
-    double bid_depth = 0.0;
-    double ask_depth = 0.0;
-    for (auto it = bids_.lower_bound(lower); it != bids_.end(); ++it) {
-        bid_depth += it->second;
-    }
-    for (auto it = asks_.begin(); it != asks_.end() && it->first <= upper; ++it) {
-        if (it->first < upper) ask_depth += it->second;
-        else break;
-    }
-    return {bid_depth, ask_depth};
-}
-
 void OrderFlowFeatureExtractor::add_trade(double ts, double price, double volume, Side side) {
+    SWEEP_LATENCY_SCOPE(AddTrade);
+    advance_to(ts);
     last_price_ = price;
     last_tick_ts_ = ts;
+    if (ts > event_ts_) event_ts_ = ts;
     trades_.push_back({ts, volume, side});
+    for (VolumeWindow& w : vol_win_) {
+        if (side == Side::Buy) w.buy += volume;
+        else w.sell += volume;
+    }
     prune_trades(ts);
     update_bucket(ts, volume, side);
     refresh_agg_run();
+    sample_mid();
+
+    if (schedule_.every_n_trades > 0 && ++trades_since_frame_ >= schedule_.every_n_trades) {
+        trades_since_frame_ = 0;
+        emit_frame(ts, FrameTrigger::Trades);
+    }
 }
 
 void OrderFlowFeatureExtractor::apply_l2_snapshot(
     const std::vector<std::pair<double, double>>& bids,
     const std::vector<std::pair<double, double>>& asks) {
-    apply_book_entries(bids, asks, true);
+    SWEEP_LATENCY_SCOPE(ApplyL2Snapshot);
+    book_.apply_snapshot(bids, asks);
+    ++book_version_;
+    sample_mid();
 }
 
 void OrderFlowFeatureExtractor::apply_l2_delta(
     const std::vector<std::pair<double, double>>& bids,
     const std::vector<std::pair<double, double>>& asks) {
-    apply_book_entries(bids, asks, false);
+    SWEEP_LATENCY_SCOPE(ApplyL2Delta);
+    book_.apply_delta(bids, asks);
+    ++book_version_;
+    sample_mid();
 }
 
-OrderFlowFrame OrderFlowFeatureExtractor::get_frame(double ts_now) {
-    OrderFlowFrame f;
-    if (ts_now <= 0.0) ts_now = last_tick_ts_;
-    f.ts = ts_now;
+void OrderFlowFeatureExtractor::apply_l2_snapshot(const double* bids, std::size_t n_bids,
+                                                  const double* asks, std::size_t n_asks) {
+    SWEEP_LATENCY_SCOPE(ApplyL2Snapshot);
+    book_.clear();
+    book_.apply_bids(bids, n_bids);
+    book_.apply_asks(asks, n_asks);
+    ++book_version_;
+    sample_mid();
+}
 
-    prune_trades(ts_now);
-    refresh_agg_run();
+void OrderFlowFeatureExtractor::apply_l2_delta(const double* bids, std::size_t n_bids,
+                                               const double* asks, std::size_t n_asks) {
+    SWEEP_LATENCY_SCOPE(ApplyL2Delta);
+    book_.apply_bids(bids, n_bids);
+    book_.apply_asks(asks, n_asks);
+    ++book_version_;
+    sample_mid();
+}
 
-    double buy1 = 0.0, sell1 = 0.0, buy3 = 0.0, sell3 = 0.0, buy10 = 0.0, sell10 = 0.0;
-    for (const auto& t : trades_) {
-        double age = ts_now - t.ts;
-        if (age < 0.0) continue;
-        if (age <= 10.0) {
-            if (t.side == Side::Buy) buy10 += t.volume;
-            else sell10 += t.volume;
-            if (age <= 3.0) {
-                if (t.side == Side::Buy) buy3 += t.volume;
-                else sell3 += t.volume;
-            }
-            if (age <= 1.0) {
-                if (t.side == Side::Buy) buy1 += t.volume;
-                else sell1 += t.volume;
-            }
-        }
+// 每条成交 / 盘口更新后把当前 mid 记进 20s / 30s 极值；盘口不带时间戳，记在最近的事件时间上
+void OrderFlowFeatureExtractor::sample_mid() {
+    double bid = book_.best_bid();
+    double ask = book_.best_ask();
+    double mid = (bid > 0.0 && ask > 0.0) ? 0.5 * (bid + ask) : last_price_;
+    if (mid > 0.0) highlow_.add(event_ts_, mid);
+}
+
+void OrderFlowFeatureExtractor::window_volume_at(const VolumeWindow& w, double ts_now,
+                                                 double& buy, double& sell) const {
+    buy = w.buy;
+    sell = w.sell;
+    std::size_t k = w.begin;
+    while (k < trades_.size() && ts_now - trades_[k].ts > w.horizon) {
+        const TradePoint& t = trades_[k];
+        if (t.side == Side::Buy) buy -= t.volume;
+        else sell -= t.volume;
+        ++k;
+    }
+    if (k == trades_.size()) {
+        buy = 0.0;
+        sell = 0.0;
+    }
+}
+
+// agg_run_dir_ 由最近 3 个桶决定；ts_now 时其中有桶已过 5s 截止线则不成立
+AggRunDir OrderFlowFeatureExtractor::agg_run_at(double ts_now) const {
+    std::size_t n = buckets_.size();
+    int cutoff_sec = static_cast<int>(std::floor(ts_now)) - 5;
+    if (n < 3 || buckets_[n - 3].sec < cutoff_sec) return AggRunDir::None;
+    return agg_run_dir_;
+}
+
+OrderFlowFrame OrderFlowFeatureExtractor::get_frame(double ts_now) const {
+    SWEEP_LATENCY_SCOPE(GetFrame);
+    if (ts_now <= 0.0) ts_now = last_tick_ts_;
+    check_frame_ts(ts_now);
+    if (book_cache_fresh()) return frame_at(ts_now, cached_book_);
+    OrderFlowFrame book;
+    compute_book_features(book);
+    return frame_at(ts_now, book);
+}
+
+void OrderFlowFeatureExtractor::check_frame_ts(double ts_now) const {
+    if (ts_now < last_tick_ts_) {
+        throw std::invalid_argument("OrderFlowFeatureExtractor: frame ts is earlier than the last trade");
     }
+}
+
+OrderFlowFrame OrderFlowFeatureExtractor::frame_at(double ts_now, const OrderFlowFrame& book) const {
+    OrderFlowFrame f;
+    f.ts = ts_now;
+
+    double buy1, sell1, buy3, sell3, buy10, sell10;
+    window_volume_at(vol_win_[0], ts_now, buy1, sell1);
+    window_volume_at(vol_win_[1], ts_now, buy3, sell3);
+    window_volume_at(vol_win_[2], ts_now, buy10, sell10);
 
     auto share = [](double b, double s) -> std::pair<double, double> {
         double tot = b + s;
@@ -187,42 +234,264 @@ OrderFlowFrame OrderFlowFeatureExtractor::get_frame(double ts_now) {
     f.buy_share_3s = s3.first; f.sell_share_3s = s3.second;
     f.buy_share_10s = s10.first; f.sell_share_10s = s10.second;
 
-    f.best_bid = best_bid();
-    f.best_ask = best_ask();
-    if (f.best_bid > 0.0 && f.best_ask > 0.0) {
-        f.mid = 0.5 * (f.best_bid + f.best_ask);
+    f.best_bid = book.best_bid;
+    f.best_ask = book.best_ask;
+    f.mid = book.mid;
+    f.liq01_bid = book.liq01_bid; f.liq01_ask = book.liq01_ask;
+    f.liq03_bid = book.liq03_bid; f.liq03_ask = book.liq03_ask;
+    f.liq05_bid = book.liq05_bid; f.liq05_ask = book.liq05_ask;
+    f.weak_side_01 = book.weak_side_01;
+
+    // 高低点检测：当前 mid 与窗口内各次成交 / 盘口更新后的 mid 比较
+    if (f.mid > 0.0) {
+        f.is_new_high_20s = highlow_.is_max_with(kExtreme20s, ts_now, f.mid);
+        f.is_new_low_20s  = highlow_.is_min_with(kExtreme20s, ts_now, f.mid);
+        f.is_new_high_30s = highlow_.is_max_with(kExtreme30s, ts_now, f.mid);
+        f.is_new_low_30s  = highlow_.is_min_with(kExtreme30s, ts_now, f.mid);
+    }
+
+    f.agg_run_dir = agg_run_at(ts_now);
+    return f;
+}
+
+void OrderFlowFeatureExtractor::compute_book_features(OrderFlowFrame& c) const {
+    c = OrderFlowFrame();
+    c.best_bid = book_.best_bid();
+    c.best_ask = book_.best_ask();
+    if (c.best_bid > 0.0 && c.best_ask > 0.0) {
+        c.mid = 0.5 * (c.best_bid + c.best_ask);
     } else {
-        f.mid = last_price_;
+        c.mid = last_price_;
     }
 
-    if (f.mid > 0.0) {
-        auto d01 = depth_within(f.mid, 0.001);
-        auto d03 = depth_within(f.mid, 0.003);
-        auto d05 = depth_within(f.mid, 0.005);
-        f.liq01_bid = d01.first; f.liq01_ask = d01.second;
-        f.liq03_bid = d03.first; f.liq03_ask = d03.second;
-        f.liq05_bid = d05.first; f.liq05_ask = d05.second;
+    if (c.mid > 0.0) {
+        auto d01 = book_.depth_within(c.mid, 0.001);
+        auto d03 = book_.depth_within(c.mid, 0.003);
+        auto d05 = book_.depth_within(c.mid, 0.005);
+        c.liq01_bid = d01.first; c.liq01_ask = d01.second;
+        c.liq03_bid = d03.first; c.liq03_ask = d03.second;
+        c.liq05_bid = d05.first; c.liq05_ask = d05.second;
     }
 
     // 弱侧检测：0.1% 档
-    if (f.liq01_bid > 0.0 && f.liq01_ask > 0.0) {
-        if (f.liq01_bid < 0.4 * f.liq01_ask) {
-            f.weak_side_01 = WeakSide::Bid;
-        } else if (f.liq01_ask < 0.4 * f.liq01_bid) {
-            f.weak_side_01 = WeakSide::Ask;
+    if (c.liq01_bid > 0.0 && c.liq01_ask > 0.0) {
+        if (c.liq01_bid < 0.4 * c.liq01_ask) {
+            c.weak_side_01 = WeakSide::Bid;
+        } else if (c.liq01_ask < 0.4 * c.liq01_bid) {
+            c.weak_side_01 = WeakSide::Ask;
         }
     }
+}
 
-    // 高低点检测
-    if (f.mid > 0.0) {
-        highlow_20s_.add(ts_now, f.mid);
-        highlow_30s_.add(ts_now, f.mid);
-        f.is_new_high_20s = (!highlow_20s_.empty() && f.mid >= highlow_20s_.current_max());
-        f.is_new_low_20s  = (!highlow_20s_.empty() && f.mid <= highlow_20s_.current_min());
-        f.is_new_high_30s = (!highlow_30s_.empty() && f.mid >= highlow_30s_.current_max());
-        f.is_new_low_30s  = (!highlow_30s_.empty() && f.mid <= highlow_30s_.current_min());
-    }
+bool OrderFlowFeatureExtractor::book_cache_fresh() const {
+    const OrderFlowFrame& c = cached_book_;
+    bool two_sided = c.best_bid > 0.0 && c.best_ask > 0.0;
+    return book_version_ == cached_book_version_ &&
+           (two_sided || last_price_ == cached_fallback_price_);
+}
+
+void OrderFlowFeatureExtractor::refresh_book_cache() {
+    if (book_cache_fresh()) return;
+    compute_book_features(cached_book_);
+    cached_book_version_ = book_version_;
+    cached_fallback_price_ = last_price_;
+}
+
+// ---------------- 帧调度 ----------------
+
+namespace {
+
+// 除 ts 外所有字段相同
+bool same_features(const OrderFlowFrame& a, OrderFlowFrame b) {
+    b.ts = a.ts;
+#define ORDERFLOW_FRAME_FIELD_EQ(T, name) && a.name == b.name
+    return true ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_FIELD_EQ);
+#undef ORDERFLOW_FRAME_FIELD_EQ
+}
 
-    f.agg_run_dir = agg_run_dir_;
+// 帧按列类型逐字段读写（bool / 枚举不直接 memcpy）
+void put_frame(StateWriter& w, const OrderFlowFrame& f) {
+#define ORDERFLOW_FRAME_FIELD_PUT(T, name) w.put(static_cast<T>(f.name));
+    ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_FIELD_PUT)
+#undef ORDERFLOW_FRAME_FIELD_PUT
+}
+
+OrderFlowFrame get_frame_state(StateReader& r) {
+    OrderFlowFrame f;
+#define ORDERFLOW_FRAME_FIELD_GET(T, name) f.name = static_cast<decltype(f.name)>(r.get<T>());
+    ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_FIELD_GET)
+#undef ORDERFLOW_FRAME_FIELD_GET
     return f;
 }
+
+}  // namespace
+
+void OrderFlowFeatureExtractor::set_schedule(const FrameSchedule& schedule) {
+    schedule_ = schedule;
+    sched_started_ = false;
+    trades_since_frame_ = 0;
+    has_last_emitted_ = false;
+}
+
+void OrderFlowFeatureExtractor::advance_to(double ts) {
+    if (ts > event_ts_) event_ts_ = ts;
+    const double interval = schedule_.interval_sec;
+    if (!(interval > 0.0)) return;
+    if (!sched_started_) {
+        // 第一帧：不早于第一条事件的网格点
+        next_frame_ = static_cast<int64_t>(std::ceil(ts / interval));
+        sched_started_ = true;
+        return;
+    }
+    for (;;) {
+        double t = static_cast<double>(next_frame_) * interval;
+        if (!(t < ts)) break;
+        emit_frame(t, FrameTrigger::Interval);
+        ++next_frame_;
+    }
+}
+
+void OrderFlowFeatureExtractor::on_sweep(const SweepEventMeta& ev) {
+    if (!schedule_.on_sweep) return;
+    advance_to(ev.ts_end);
+    emit_frame(ev.ts_end, FrameTrigger::Sweep);
+}
+
+void OrderFlowFeatureExtractor::emit_frame(double ts, FrameTrigger trigger) {
+    SWEEP_LATENCY_SCOPE(GetFrame);
+    refresh_book_cache();
+    OrderFlowFrame f = frame_at(ts, cached_book_);
+    if (trigger == FrameTrigger::Interval && schedule_.skip_unchanged && has_last_emitted_ &&
+        same_features(f, last_emitted_)) {
+        return;
+    }
+    scheduled_.push_back(f);
+    scheduled_trigger_.push_back(static_cast<uint8_t>(trigger));
+    last_emitted_ = f;
+    has_last_emitted_ = true;
+}
+
+void OrderFlowFeatureExtractor::clear_scheduled_frames() {
+    scheduled_.clear();
+    scheduled_trigger_.clear();
+}
+
+void OrderFlowFeatureExtractor::get_frames(const double* ts, std::size_t n,
+                                           OrderFlowFrameColumns& out) const {
+    // 先整体检查，不输出半批
+    for (std::size_t i = 0; i < n; ++i) {
+        if (ts[i] > 0.0) check_frame_ts(ts[i]);
+    }
+    // 一批之内盘口不变：盘口特征只算一次，放在本次调用的局部变量里
+    OrderFlowFrame book;
+    if (book_cache_fresh()) book = cached_book_;
+    else compute_book_features(book);
+    out.reserve(out.size() + n);
+    for (std::size_t i = 0; i < n; ++i) {
+        out.push_back(frame_at(ts[i] > 0.0 ? ts[i] : last_tick_ts_, book));
+    }
+}
+
+void OrderFlowFrameColumns::to_records(OrderFlowFrameRecord* out) const {
+    std::size_t n = size();
+    for (std::size_t i = 0; i < n; ++i) {
+        OrderFlowFrameRecord& r = out[i];
+#define ORDERFLOW_FRAME_COLUMN_ROW(T, name) r.name = name[i];
+        ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_COLUMN_ROW)
+#undef ORDERFLOW_FRAME_COLUMN_ROW
+        r.reserved[0] = 0;
+        r.reserved[1] = 0;
+    }
+}
+
+std::string OrderFlowFeatureExtractor::serialize() const {
+    StateWriter w(kExtractorStateMagic);
+    for (const VolumeWindow& v : vol_win_) w.put(v.horizon);
+    w.put(book_.tick_size());
+    w.put(highlow_.bucket_sec());
+
+    w.put(static_cast<uint64_t>(trades_.size()));
+    for (std::size_t i = 0; i < trades_.size(); ++i) {
+        w.put(trades_[i].ts);
+        w.put(trades_[i].volume);
+        w.put(static_cast<int8_t>(trades_[i].side));
+    }
+    for (const VolumeWindow& v : vol_win_) {
+        w.put(static_cast<uint64_t>(v.begin));
+        w.put(v.buy);
+        w.put(v.sell);
+    }
+    w.put(static_cast<uint64_t>(buckets_.size()));
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        w.put(static_cast<int32_t>(buckets_[i].sec));
+        w.put(buckets_[i].buy);
+        w.put(buckets_[i].sell);
+    }
+    w.put(last_price_);
+    w.put(last_tick_ts_);
+    book_.save_state(w);
+    highlow_.save_state(w);
+    w.put(static_cast<int8_t>(agg_run_dir_));
+
+    // 调度配置与进度（已出的帧不在快照里）
+    w.put(schedule_.interval_sec);
+    w.put(schedule_.every_n_trades);
+    w.put(schedule_.on_sweep);
+    w.put(schedule_.skip_unchanged);
+    w.put(sched_started_);
+    w.put(next_frame_);
+    w.put(trades_since_frame_);
+    w.put(has_last_emitted_);
+    put_frame(w, last_emitted_);
+    return w.take();
+}
+
+OrderFlowFeatureExtractor OrderFlowFeatureExtractor::deserialize(const std::string& data) {
+    StateReader r(data, kExtractorStateMagic);
+    double h[3];
+    for (double& v : h) v = r.get<double>();
+    double tick_size = r.get<double>();
+    double extreme_bucket_sec = r.get<double>();
+    OrderFlowFeatureExtractor ex(h[0], h[1], h[2], tick_size, extreme_bucket_sec);
+
+    std::size_t n = static_cast<std::size_t>(r.get<uint64_t>());
+    for (std::size_t i = 0; i < n; ++i) {
+        TradePoint t;
+        t.ts = r.get<double>();
+        t.volume = r.get<double>();
+        t.side = r.get<int8_t>() > 0 ? Side::Buy : Side::Sell;
+        ex.trades_.push_back(t);
+    }
+    for (VolumeWindow& v : ex.vol_win_) {
+        v.begin = static_cast<std::size_t>(r.get<uint64_t>());
+        v.buy = r.get<double>();
+        v.sell = r.get<double>();
+        if (v.begin > n) throw std::runtime_error("state: corrupt trade window");
+    }
+    std::size_t nb = static_cast<std::size_t>(r.get<uint64_t>());
+    for (std::size_t i = 0; i < nb; ++i) {
+        AggBucket b;
+        b.sec = r.get<int32_t>();
+        b.buy = r.get<double>();
+        b.sell = r.get<double>();
+        ex.buckets_.push_back(b);
+    }
+    ex.last_price_ = r.get<double>();
+    ex.last_tick_ts_ = r.get<double>();
+    ex.event_ts_ = ex.last_tick_ts_;
+    ex.book_.load_state(r);
+    ex.highlow_.load_state(r);
+    ex.agg_run_dir_ = static_cast<AggRunDir>(r.get<int8_t>());
+
+    ex.schedule_.interval_sec = r.get<double>();
+    ex.schedule_.every_n_trades = r.get<int64_t>();
+    ex.schedule_.on_sweep = r.get<bool>();
+    ex.schedule_.skip_unchanged = r.get<bool>();
+    ex.sched_started_ = r.get<bool>();
+    ex.next_frame_ = r.get<int64_t>();
+    ex.trades_since_frame_ = r.get<int64_t>();
+    ex.has_last_emitted_ = r.get<bool>();
+    ex.last_emitted_ = get_frame_state(r);
+    r.finish();
+    return ex;
+}
@@ -1,11 +1,14 @@
 #pragma once
-#include <deque>
-#include <map>
+#include <string>
 #include <vector>
 #include <utility>
 #include <cstdint>
 
 #include "sweep_model.h"  // for Side enum
+#include "ring_buffer.h"
+#include "l2_book.h"
+#include "state_io.h"
+#include "bucketed_extremes.h"
 
 // 方向标记
 enum class AggRunDir : int8_t { None = 0, Buy = 1, Sell = -1 };
@@ -47,50 +50,101 @@ struct OrderFlowFrame {
     WeakSide weak_side_01 = WeakSide::None;
 };
 
-// 滑窗极值（高/低）维护：O(1) 入队 / 过期 / 查询
-class RollingExtreme {
-public:
-    explicit RollingExtreme(double window_sec)
-        : window_sec_(window_sec) {}
-
-    void add(double ts, double value) {
-        // 维护 max
-        while (!max_q_.empty() && max_q_.back().second <= value) {
-            max_q_.pop_back();
-        }
-        max_q_.emplace_back(ts, value);
-
-        // 维护 min
-        while (!min_q_.empty() && min_q_.back().second >= value) {
-            min_q_.pop_back();
-        }
-        min_q_.emplace_back(ts, value);
-
-        evict(ts);
+// OrderFlowFrame 的字段表（顺序与结构体一致）：X(列类型, 字段名)
+// bool 列存 uint8，方向枚举存 int8；列式缓冲 / Python 导出都从这里展开，加字段只改一处
+#define ORDERFLOW_FRAME_COLUMNS(X) \
+    X(double, ts)                  \
+    X(double, mid)                 \
+    X(double, best_bid)            \
+    X(double, best_ask)            \
+    X(double, buy_vol_1s)          \
+    X(double, sell_vol_1s)         \
+    X(double, buy_vol_3s)          \
+    X(double, sell_vol_3s)         \
+    X(double, buy_vol_10s)         \
+    X(double, sell_vol_10s)        \
+    X(double, buy_share_1s)        \
+    X(double, sell_share_1s)       \
+    X(double, buy_share_3s)        \
+    X(double, sell_share_3s)       \
+    X(double, buy_share_10s)       \
+    X(double, sell_share_10s)      \
+    X(double, liq01_bid)           \
+    X(double, liq01_ask)           \
+    X(double, liq03_bid)           \
+    X(double, liq03_ask)           \
+    X(double, liq05_bid)           \
+    X(double, liq05_ask)           \
+    X(uint8_t, is_new_high_20s)    \
+    X(uint8_t, is_new_low_20s)     \
+    X(uint8_t, is_new_high_30s)    \
+    X(uint8_t, is_new_low_30s)     \
+    X(int8_t, agg_run_dir)         \
+    X(int8_t, weak_side_01)
+
+// 定长帧记录（NumPy 结构化数组 / 落盘 memmap 用）：字段与 ORDERFLOW_FRAME_COLUMNS 一一对应，
+// 184 字节、本机字节序；布局有变化时 kFrameRecordVersion 加一，旧文件按版本号识别
+constexpr uint32_t kFrameRecordVersion = 1;
+
+struct OrderFlowFrameRecord {
+#define ORDERFLOW_FRAME_RECORD_DECL(T, name) T name;
+    ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_RECORD_DECL)
+#undef ORDERFLOW_FRAME_RECORD_DECL
+    uint8_t reserved[2];  // 显式填充到 8 字节对齐，写出时为 0
+};
+static_assert(sizeof(OrderFlowFrameRecord) == 184, "OrderFlowFrameRecord layout changed");
+
+// 列式帧缓冲：每个字段一列，reserve 之后逐帧追加不再分配
+struct OrderFlowFrameColumns {
+#define ORDERFLOW_FRAME_COLUMN_DECL(T, name) std::vector<T> name;
+    ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_COLUMN_DECL)
+#undef ORDERFLOW_FRAME_COLUMN_DECL
+
+    std::size_t size() const { return ts.size(); }
+
+    void reserve(std::size_t n) {
+#define ORDERFLOW_FRAME_COLUMN_RESERVE(T, name) name.reserve(n);
+        ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_COLUMN_RESERVE)
+#undef ORDERFLOW_FRAME_COLUMN_RESERVE
     }
 
-    void evict(double ts_now) {
-        while (!max_q_.empty() && ts_now - max_q_.front().first > window_sec_) {
-            max_q_.pop_front();
-        }
-        while (!min_q_.empty() && ts_now - min_q_.front().first > window_sec_) {
-            min_q_.pop_front();
-        }
+    void clear() {
+#define ORDERFLOW_FRAME_COLUMN_CLEAR(T, name) name.clear();
+        ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_COLUMN_CLEAR)
+#undef ORDERFLOW_FRAME_COLUMN_CLEAR
     }
 
-    bool empty() const { return max_q_.empty() || min_q_.empty(); }
-    double current_max() const { return max_q_.empty() ? 0.0 : max_q_.front().second; }
-    double current_min() const { return min_q_.empty() ? 0.0 : min_q_.front().second; }
+    void push_back(const OrderFlowFrame& f) {
+#define ORDERFLOW_FRAME_COLUMN_PUSH(T, name) name.push_back(static_cast<T>(f.name));
+        ORDERFLOW_FRAME_COLUMNS(ORDERFLOW_FRAME_COLUMN_PUSH)
+#undef ORDERFLOW_FRAME_COLUMN_PUSH
+    }
 
-private:
-    double window_sec_;
-    std::deque<std::pair<double, double>> max_q_;
-    std::deque<std::pair<double, double>> min_q_;
+    // 列 -> 行：写 size() 条记录到 out（调用方预分配）
+    void to_records(OrderFlowFrameRecord* out) const;
+};
+
+// 帧调度：由数据的事件时间驱动出帧，结果与调用方轮询频率无关
+// 三种触发可以同时打开；全部为 0 / false 时不调度（只用 get_frame 手动取）
+struct FrameSchedule {
+    double  interval_sec = 0.0;   // >0：每个 interval_sec 整数倍的时刻一帧
+    int64_t every_n_trades = 0;   // >0：每 N 笔成交后一帧（帧时间为第 N 笔的 ts）
+    bool    on_sweep = false;     // on_sweep(ev) 时一帧（帧时间为 ev.ts_end）
+    bool    skip_unchanged = false;  // 定时帧与上一帧除 ts 外完全相同时不输出（静默期省空间）
 };
 
+enum class FrameTrigger : uint8_t { Interval = 1, Trades = 2, Sweep = 3 };
+
 class OrderFlowFeatureExtractor {
 public:
-    OrderFlowFeatureExtractor();
+    // 三档成交量窗口（秒），对应 frame 里的 *_1s / *_3s / *_10s 字段
+    // tick_size：L2 价格档位（ETHUSDT 为 0.01）
+    // extreme_bucket_sec：20s / 30s 新高新低的时间桶宽，窗口边界按桶对齐（误差不超过一个桶）
+    explicit OrderFlowFeatureExtractor(double vol_win_1 = 1.0,
+                                       double vol_win_2 = 3.0,
+                                       double vol_win_3 = 10.0,
+                                       double tick_size = 0.01,
+                                       double extreme_bucket_sec = 0.05);
 
     // trades: ts 秒, price, volume, side
     void add_trade(double ts, double price, double volume, Side side);
@@ -101,8 +155,47 @@ public:
     void apply_l2_delta(const std::vector<std::pair<double, double>>& bids,
                         const std::vector<std::pair<double, double>>& asks);
 
-    // 组合一帧特征；ts_now 用 last_tick_ts_ 兜底
-    OrderFlowFrame get_frame(double ts_now = 0.0);
+    // 列式版本：bids / asks 为 N×2 (price, size) 行主序数组，不经过中间容器
+    void apply_l2_snapshot(const double* bids, std::size_t n_bids,
+                           const double* asks, std::size_t n_asks);
+    void apply_l2_delta(const double* bids, std::size_t n_bids,
+                        const double* asks, std::size_t n_asks);
+
+    // 组合一帧特征；ts_now <= 0 用 last_tick_ts_ 兜底，早于最后一条成交时抛 invalid_argument
+    // 只读：不移动窗口游标、不往 20s / 30s 极值里采样、不写任何成员，可与其它只读调用并发
+    // is_new_high / low 与每次成交 / 盘口更新后的 mid 历史比较，与是否设调度无关
+    OrderFlowFrame get_frame(double ts_now = 0.0) const;
+
+    // 批量取帧：同 get_frame(ts[i])，追加到列式缓冲；ts 之间不要求有序，
+    // 任一 ts 早于最后一条成交时整批不输出、抛 invalid_argument
+    void get_frames(const double* ts, std::size_t n, OrderFlowFrameColumns& out) const;
+
+    // ---- 帧调度 ----
+    // 定时帧 t 在所有 ts <= t 的成交之后、第一条 ts > t 的成交之前计算
+    // 盘口更新不带时间戳：先 advance_to(盘口 ts) 再 apply，定时帧才会落在正确的一侧（ReplayEngine 即如此）
+    // 设置后从下一条事件重新对齐网格、重新计数；已出的帧保留
+    void set_schedule(const FrameSchedule& schedule);
+    const FrameSchedule& schedule() const { return schedule_; }
+
+    // 事件时间推进到 ts：出完时间 < ts 的定时帧（实盘可由定时器调用，之后的事件 ts 须 >= 它）
+    void advance_to(double ts);
+
+    // sweep 事件（来自 SweepDetector）：schedule.on_sweep 时出一帧
+    void on_sweep(const SweepEventMeta& ev);
+
+    // 调度产生的帧及各自的触发原因（FrameTrigger），调用方取走后 clear
+    const OrderFlowFrameColumns& scheduled_frames() const { return scheduled_; }
+    OrderFlowFrameColumns& scheduled_frames() { return scheduled_; }
+    const std::vector<uint8_t>& scheduled_triggers() const { return scheduled_trigger_; }
+    std::vector<uint8_t>& scheduled_triggers() { return scheduled_trigger_; }
+    void clear_scheduled_frames();
+
+    const L2Book& book() const { return book_; }
+
+    // 状态快照：成交窗口、1s 桶、订单簿、20s / 30s 极值队列，用于热备接管 / pickle
+    // 恢复后不需要重新积累窗口，也不用等新的 L2 snapshot
+    std::string serialize() const;
+    static OrderFlowFeatureExtractor deserialize(const std::string& data);
 
 private:
     struct TradePoint {
@@ -111,33 +204,66 @@ private:
         Side side;
     };
 
+    // 增量滑窗：trades_ 里 [begin, size) 为最近 horizon 秒，buy/sell 为其累计量
+    struct VolumeWindow {
+        double horizon;
+        std::size_t begin;
+        double buy;
+        double sell;
+    };
+
     struct AggBucket {
         int sec;       // floor(ts)
         double buy;
         double sell;
     };
 
-    std::deque<TradePoint> trades_;   // 保存 <=10s 的 trade
-    std::deque<AggBucket> buckets_;   // 最近 5 个 1s 桶
+    RingBuffer<TradePoint> trades_;   // 保存最长窗口内的 trade
+    VolumeWindow vol_win_[3];         // 各窗口共用 trades_，add 时累加、游标驱逐时扣减
+    RingBuffer<AggBucket> buckets_{8};  // 最近 5 个 1s 桶
 
     double last_price_ = 0.0;
     double last_tick_ts_ = 0.0;
+    double event_ts_ = 0.0;  // 最近的事件时间（成交或 advance_to），盘口更新记在这个时间上
 
-    std::map<double, double> bids_;   // price -> size
-    std::map<double, double> asks_;
+    L2Book book_;
 
-    RollingExtreme highlow_20s_;
-    RollingExtreme highlow_30s_;
+    // mid 的 20s / 30s 极值，两个窗口共用一个分桶结构；每条成交 / 盘口更新后采样
+    static constexpr std::size_t kExtreme20s = 0;
+    static constexpr std::size_t kExtreme30s = 1;
+    BucketedExtremes highlow_;
 
     AggRunDir agg_run_dir_ = AggRunDir::None;
 
+    // 盘口相关特征（best / mid / liq / weak side）只在盘口或兜底价变化后重算
+    // 缓存只由调度帧（非 const）更新；get_frame / get_frames 只读它，过期时在局部重算
+    uint64_t book_version_ = 0;
+    uint64_t cached_book_version_ = ~uint64_t(0);
+    double cached_fallback_price_ = 0.0;
+    OrderFlowFrame cached_book_;
+
+    FrameSchedule schedule_;
+    bool    sched_started_ = false;  // 网格已按第一条事件对齐
+    int64_t next_frame_ = 0;         // 下一定时帧的网格序号，帧时间 = next_frame_ * interval_sec
+    int64_t trades_since_frame_ = 0;
+    bool    has_last_emitted_ = false;
+    OrderFlowFrame last_emitted_;    // skip_unchanged 的比较基准
+    OrderFlowFrameColumns scheduled_;
+    std::vector<uint8_t> scheduled_trigger_;
+
+    // 推进各窗口游标（ts_now 需单调不减）
     void prune_trades(double ts_now);
     void update_bucket(double ts, double volume, Side side);
     void refresh_agg_run();
-    double best_bid() const;
-    double best_ask() const;
-    void apply_book_entries(const std::vector<std::pair<double, double>>& bids,
-                            const std::vector<std::pair<double, double>>& asks,
-                            bool snapshot);
-    std::pair<double, double> depth_within(double mid, double pct) const;
+    // ts_now 时刻窗口 w 的买卖量：游标之后已过期的 trade 临时扣掉，不移动游标
+    void window_volume_at(const VolumeWindow& w, double ts_now, double& buy, double& sell) const;
+    AggRunDir agg_run_at(double ts_now) const;
+    void check_frame_ts(double ts_now) const;
+    // 窗口 / 极值特征 + 传入的盘口特征
+    OrderFlowFrame frame_at(double ts_now, const OrderFlowFrame& book) const;
+    void compute_book_features(OrderFlowFrame& c) const;
+    bool book_cache_fresh() const;
+    void refresh_book_cache();
+    void sample_mid();
+    void emit_frame(double ts, FrameTrigger trigger);
 };
@@ -0,0 +1,209 @@
+// cpp/param_grid.cpp
+#include "param_grid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "price_move_detector.h"
+#include "trade_book_merge.h"
+
+namespace {
+
+// 带盘口回放时每批最多的组合数：批越大盘口回放摊得越薄，但各组的状态会挤出缓存
+constexpr std::size_t kMaxBookBatch = 32;
+
+std::unique_ptr<SweepDetector> make_detector(const GridParams& p) {
+    if (p.detector == DetectorKind::PriceMove) {
+        return std::make_unique<PriceMoveDetector>(p.window_sec, p.price_bp, p.vol_min);
+    }
+    SweepBaseline baseline = p.detector == DetectorKind::VolumeEwma  ? SweepBaseline::Ewma
+                           : p.detector == DetectorKind::VolumeEwmaZ ? SweepBaseline::EwmaZ
+                                                                     : SweepBaseline::Window;
+    return std::make_unique<SweepModel>(p.short_window_sec, p.long_window_sec, p.threshold_ratio,
+                                        baseline);
+}
+
+Backtester make_backtester(const GridParams& p, const FillModel* fill) {
+    MeanReversionStrategy strategy(p.delay_ms, p.hold_sec, p.tp_bp, p.sl_bp);
+    if (fill) return Backtester(*make_detector(p), strategy, *fill);
+    return Backtester(*make_detector(p), strategy);
+}
+
+void fill_result(const GridParams& p, const Backtester& bt, GridResult& r) {
+    const BacktestStats& st = bt.stats();
+    r.short_window_sec = p.short_window_sec;
+    r.long_window_sec  = p.long_window_sec;
+    r.threshold_ratio  = p.threshold_ratio;
+    r.delay_ms   = p.delay_ms;
+    r.hold_sec   = p.hold_sec;
+    r.tp_bp      = p.tp_bp;
+    r.sl_bp      = p.sl_bp;
+    r.detector   = static_cast<int32_t>(p.detector);
+    r.window_sec = p.window_sec;
+    r.price_bp   = p.price_bp;
+    r.vol_min    = p.vol_min;
+    r.sweeps     = st.sweeps;
+    r.opens      = st.opens;
+    r.closes     = st.closes;
+    r.wins       = st.wins;
+    r.losses     = st.losses;
+    r.cum_pnl_bp = st.cum_pnl_bp;
+    const FillSimulator* fs = bt.fill();
+    r.missed_entries = fs ? fs->stats().missed_entries : 0;
+    r.slippage_bp    = fs ? fs->stats().slippage_bp : 0.0;
+    r.fees_bp        = fs ? fs->stats().fees_bp : 0.0;
+}
+
+unsigned resolve_threads(unsigned num_threads, std::size_t jobs) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return static_cast<unsigned>(std::min<std::size_t>(num_threads, jobs));
+}
+
+// 调用线程也参与
+template <typename Worker>
+void run_pool(unsigned num_threads, Worker&& worker) {
+    std::vector<std::thread> pool;
+    pool.reserve(num_threads - 1);
+    for (unsigned t = 1; t < num_threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+}  // namespace
+
+void ParamGrid::add_product(const std::vector<double>& short_windows,
+                            const std::vector<double>& long_windows,
+                            const std::vector<double>& thresholds,
+                            const std::vector<double>& delays_ms,
+                            const std::vector<double>& holds_sec,
+                            const std::vector<double>& tps_bp,
+                            const std::vector<double>& sls_bp,
+                            SweepBaseline baseline) {
+    DetectorKind detector = baseline == SweepBaseline::Ewma  ? DetectorKind::VolumeEwma
+                          : baseline == SweepBaseline::EwmaZ ? DetectorKind::VolumeEwmaZ
+                                                             : DetectorKind::VolumeRatio;
+    for (double sw : short_windows)
+    for (double lw : long_windows)
+    for (double th : thresholds)
+    for (double dl : delays_ms)
+    for (double hd : holds_sec)
+    for (double tp : tps_bp)
+    for (double sl : sls_bp) {
+        GridParams p{sw, lw, th, dl, hd, tp, sl};
+        p.detector = detector;
+        params_.push_back(p);
+    }
+}
+
+void ParamGrid::add_price_move_product(const std::vector<double>& windows_sec,
+                                       const std::vector<double>& prices_bp,
+                                       const std::vector<double>& vol_mins,
+                                       const std::vector<double>& delays_ms,
+                                       const std::vector<double>& holds_sec,
+                                       const std::vector<double>& tps_bp,
+                                       const std::vector<double>& sls_bp) {
+    for (double w : windows_sec)
+    for (double bp : prices_bp)
+    for (double vm : vol_mins)
+    for (double dl : delays_ms)
+    for (double hd : holds_sec)
+    for (double tp : tps_bp)
+    for (double sl : sls_bp) {
+        GridParams p{0.0, 0.0, 0.0, dl, hd, tp, sl};
+        p.detector = DetectorKind::PriceMove;
+        p.window_sec = w;
+        p.price_bp = bp;
+        p.vol_min = vm;
+        params_.push_back(p);
+    }
+}
+
+void ParamGrid::set_fill_model(const FillModel& model) {
+    FillSimulator check(model);  // 参数不合法在这里抛出，而不是在 worker 线程里
+    fill_ = model;
+    has_fill_ = true;
+}
+
+std::vector<GridResult> ParamGrid::run(const double* ts,
+                                       const double* price,
+                                       const double* volume,
+                                       const int8_t* side,
+                                       std::size_t n,
+                                       unsigned num_threads) const {
+    std::vector<GridResult> results(params_.size());
+    if (params_.empty()) return results;
+    num_threads = resolve_threads(num_threads, params_.size());
+    const FillModel* fill = has_fill_ ? &fill_ : nullptr;
+
+    // 每个 worker 领取下一个组合：组合之间耗时差异大，动态领取比静态切分更均匀
+    std::atomic<std::size_t> next{0};
+    run_pool(num_threads, [&]() {
+        for (;;) {
+            std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= params_.size()) return;
+            Backtester bt = make_backtester(params_[i], fill);
+            bt.run(ts, price, volume, side, n);
+            fill_result(params_[i], bt, results[i]);
+        }
+    });
+    return results;
+}
+
+std::vector<GridResult> ParamGrid::run(const double* trade_ts, const double* trade_price,
+                                       const double* trade_volume, const int8_t* trade_side,
+                                       std::size_t n_trades,
+                                       const double* book_ts, const double* book_price,
+                                       const double* book_size, const int8_t* book_side,
+                                       const uint8_t* book_flags, std::size_t n_book,
+                                       unsigned num_threads) const {
+    if (!has_fill_) throw std::invalid_argument("ParamGrid: book replay needs set_fill_model()");
+    if (!std::is_sorted(trade_ts, trade_ts + n_trades) || !std::is_sorted(book_ts, book_ts + n_book)) {
+        throw std::invalid_argument("ParamGrid: input streams must be sorted by ts");
+    }
+    std::vector<GridResult> results(params_.size());
+    if (params_.empty()) return results;
+    num_threads = resolve_threads(num_threads, params_.size());
+    // 盘口回放是批内的大头，批尽量大；组合多于 线程数 × kMaxBookBatch 时仍动态领取
+    const std::size_t batch = std::min(kMaxBookBatch,
+                                       (params_.size() + num_threads - 1) / num_threads);
+
+    std::atomic<std::size_t> next{0};
+    run_pool(num_threads, [&]() {
+        std::vector<Backtester> bts;
+        bts.reserve(batch);
+        L2Book book(fill_.tick_size);
+        std::vector<double> bids, asks;
+        for (;;) {
+            std::size_t begin = next.fetch_add(batch, std::memory_order_relaxed);
+            if (begin >= params_.size()) return;
+            std::size_t end = std::min(begin + batch, params_.size());
+
+            bts.clear();
+            for (std::size_t i = begin; i < end; ++i) bts.push_back(make_backtester(params_[i], &fill_));
+            book.clear();
+            merge_trade_book(
+                trade_ts, n_trades, book_ts, book_price, book_size, book_side, book_flags, n_book,
+                bids, asks,
+                [&](std::size_t i) {
+                    Tick t{trade_ts[i], trade_price[i], trade_volume[i],
+                           trade_side[i] > 0 ? Side::Buy : Side::Sell};
+                    for (Backtester& bt : bts) bt.step(t, book);
+                },
+                [&](double ts, bool snapshot, std::size_t) {
+                    for (Backtester& bt : bts) bt.advance_to(ts, book);
+                    if (snapshot) book.clear();
+                    book.apply_bids(bids.data(), bids.size() / 2);
+                    book.apply_asks(asks.data(), asks.size() / 2);
+                    for (Backtester& bt : bts) bt.on_book(ts, book);
+                });
+            for (std::size_t i = begin; i < end; ++i) fill_result(params_[i], bts[i - begin], results[i]);
+        }
+    });
+    return results;
+}
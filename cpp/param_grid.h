@@ -0,0 +1,114 @@
+// cpp/param_grid.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "backtester.h"
+
+// 网格里可选的检测器
+enum class DetectorKind : int32_t {
+    VolumeRatio = 0,  // SweepModel
+    PriceMove   = 1,  // PriceMoveDetector
+    VolumeEwma  = 2,  // SweepModel，SweepBaseline::Ewma（long_window_sec 为时间常数）
+    VolumeEwmaZ = 3   // SweepModel，SweepBaseline::EwmaZ（threshold_ratio 为 z 阈值）
+};
+
+// 一组检测器 + MeanReversionStrategy 参数；只有 detector 对应的那组检测参数有效
+struct GridParams {
+    double short_window_sec;
+    double long_window_sec;
+    double threshold_ratio;
+    double delay_ms;
+    double hold_sec;
+    double tp_bp;
+    double sl_bp;
+    DetectorKind detector = DetectorKind::VolumeRatio;
+    double window_sec = 0.0;
+    double price_bp = 0.0;
+    double vol_min = 0.0;
+};
+
+// 结果表的一行：参数 + 回测统计
+struct GridResult {
+    double  short_window_sec;
+    double  long_window_sec;
+    double  threshold_ratio;
+    double  delay_ms;
+    double  hold_sec;
+    double  tp_bp;
+    double  sl_bp;
+    int32_t detector;
+    double  window_sec;
+    double  price_bp;
+    double  vol_min;
+    int64_t sweeps;
+    int64_t opens;
+    int64_t closes;
+    int64_t wins;
+    int64_t losses;
+    double  cum_pnl_bp;
+    // 成交模拟（没有 FillModel 时为 0），见 FillStats
+    int64_t missed_entries;
+    double  slippage_bp;
+    double  fees_bp;
+};
+
+// === 参数网格：多线程并行回测，所有 worker 共享同一份只读 tick 数据 ===
+class ParamGrid {
+public:
+    void add(const GridParams& p) { params_.push_back(p); }
+
+    // 笛卡尔积展开，顺序与嵌套循环一致（最后一个维度变化最快）
+    // baseline 决定 SweepModel 的基线（对应 detector 为 VolumeRatio / VolumeEwma / VolumeEwmaZ）
+    void add_product(const std::vector<double>& short_windows,
+                     const std::vector<double>& long_windows,
+                     const std::vector<double>& thresholds,
+                     const std::vector<double>& delays_ms,
+                     const std::vector<double>& holds_sec,
+                     const std::vector<double>& tps_bp,
+                     const std::vector<double>& sls_bp,
+                     SweepBaseline baseline = SweepBaseline::Window);
+
+    // PriceMoveDetector 的笛卡尔积，顺序规则同上
+    void add_price_move_product(const std::vector<double>& windows_sec,
+                                const std::vector<double>& prices_bp,
+                                const std::vector<double>& vol_mins,
+                                const std::vector<double>& delays_ms,
+                                const std::vector<double>& holds_sec,
+                                const std::vector<double>& tps_bp,
+                                const std::vector<double>& sls_bp);
+
+    std::size_t size() const { return params_.size(); }
+    const std::vector<GridParams>& params() const { return params_; }
+
+    // 所有组合共用的成交模拟（同一 seed，各组面对同样的延迟序列）；不设置时按策略价格理想成交
+    void set_fill_model(const FillModel& model);
+    void clear_fill_model() { has_fill_ = false; }
+    bool has_fill_model() const { return has_fill_; }
+    const FillModel& fill_model() const { return fill_; }
+
+    // num_threads=0 时用 hardware_concurrency；结果与 params() 同序
+    std::vector<GridResult> run(const double* ts,
+                                const double* price,
+                                const double* volume,
+                                const int8_t* side,
+                                std::size_t n,
+                                unsigned num_threads = 0) const;
+
+    // 成交 + 盘口（约定同 ReplayEngine::run），需要先 set_fill_model
+    // worker 一次领一批组合，盘口在批内只回放一遍、所有组合共享，不随组合数线性变慢
+    // 未排序抛 std::invalid_argument（在启动线程之前检查）
+    std::vector<GridResult> run(const double* trade_ts, const double* trade_price,
+                                const double* trade_volume, const int8_t* trade_side,
+                                std::size_t n_trades,
+                                const double* book_ts, const double* book_price,
+                                const double* book_size, const int8_t* book_side,
+                                const uint8_t* book_flags, std::size_t n_book,
+                                unsigned num_threads = 0) const;
+
+private:
+    std::vector<GridParams> params_;
+    bool has_fill_ = false;
+    FillModel fill_;
+};
@@ -0,0 +1,64 @@
+// cpp/price_move_detector.cpp
+#include "price_move_detector.h"
+
+PriceMoveDetector::PriceMoveDetector(double window_sec, double price_bp, double vol_min)
+    : window_sec_(window_sec), price_bp_(price_bp), vol_min_(vol_min) {}
+
+void PriceMoveDetector::close_front() {
+    const PriceTick& base = window_.front();
+    double base_p = base.price;
+    double up_max = at_seq(max_q_.front()).price;
+    double dn_min = at_seq(min_q_.front()).price;
+
+    double up_bp = (up_max - base_p) / base_p * 10000.0;
+    double dn_bp = (base_p - dn_min) / base_p * 10000.0;
+
+    int dir = 0;
+    double vol = 0.0;
+    if (up_bp >= price_bp_ && (vol = by_price_.sum_at_least(base_p)) >= vol_min_) {
+        dir = 1;
+    } else if (dn_bp >= price_bp_ && (vol = by_price_.sum_at_most(base_p)) >= vol_min_) {
+        dir = -1;
+    }
+
+    if (dir != 0) {
+        last_event_.ts_start     = base.timestamp;
+        last_event_.ts_end       = window_.back().timestamp;
+        last_event_.price_start  = base_p;
+        last_event_.price_end    = dir > 0 ? up_max : dn_min;
+        last_event_.volume_total = vol;
+        last_event_.direction    = dir;
+        events_.push_back(last_event_);
+    }
+
+    by_price_.erase(base_p, head_seq_);
+    window_.pop_front();
+    ++head_seq_;
+    if (max_q_.front() < head_seq_) max_q_.pop_front();
+    if (min_q_.front() < head_seq_) min_q_.pop_front();
+}
+
+SweepSignal PriceMoveDetector::process_tick(const Tick& tick) {
+    events_.clear();
+
+    // 新 tick 超出的窗口全部结束（起点按时间有序，从队首依次结算）
+    while (!window_.empty() && tick.timestamp - window_.front().timestamp > window_sec_) {
+        close_front();
+    }
+
+    uint64_t seq = head_seq_ + window_.size();
+    window_.push_back({tick.timestamp, tick.price, tick.volume});
+    by_price_.insert(tick.price, seq, tick.volume);
+    while (!max_q_.empty() && at_seq(max_q_.back()).price <= tick.price) max_q_.pop_back();
+    max_q_.push_back(seq);
+    while (!min_q_.empty() && at_seq(min_q_.back()).price >= tick.price) min_q_.pop_back();
+    min_q_.push_back(seq);
+
+    return last_signal(events_);
+}
+
+SweepSignal PriceMoveDetector::flush() {
+    events_.clear();
+    while (!window_.empty()) close_front();
+    return last_signal(events_);
+}
@@ -0,0 +1,63 @@
+// cpp/price_move_detector.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "price_volume_tree.h"
+#include "ring_buffer.h"
+#include "sweep_model.h"
+
+// === 价格位移型 sweep 检测：sweep_param_scan.py::detect_sweeps_py 的流式版本 ===
+// 每条 tick 都是一个窗口起点 base，窗口为 ts ∈ [base.ts, base.ts + window_sec] 的成交：
+//   (窗口最高价 - base) / base >= price_bp 且 价格 >= base 的成交量 >= vol_min -> Up
+//   否则 (base - 窗口最低价) / base >= price_bp 且 价格 <= base 的成交量 >= vol_min -> Down
+// 窗口要等第一条 ts > base.ts + window_sec 的 tick 到来才结束，事件在这条 tick 上确认
+// （ts_end 仍是窗口内最后一条成交的时间）；同一条 tick 可以同时结束多个窗口
+// 数据结束时调 flush() 结算剩下的窗口，事件序列与 detect_sweeps_py 逐条一致
+//
+// 双指针：窗口起点 / 终点都只前进；区间极值用单调队列，每条 tick 均摊 O(1)
+// 按价格划归的成交量用按价格有序的 PriceVolumeTree（子树和）查询，每条 tick 期望 O(log 窗口内成交数)，
+// 单边行情里也不再逐条扫窗口；求和顺序与 Python 不同，volume_total 只在末位舍入上可能有差别
+class PriceMoveDetector : public SweepDetector {
+public:
+    PriceMoveDetector(double window_sec = 0.3,
+                      double price_bp   = 5.0,
+                      double vol_min    = 5.0);
+
+    SweepSignal process_tick(const Tick& tick) override;
+    SweepSignal flush() override;
+
+    std::unique_ptr<SweepDetector> clone() const override {
+        return std::make_unique<PriceMoveDetector>(*this);
+    }
+
+    double window_sec() const { return window_sec_; }
+    double price_bp() const { return price_bp_; }
+    double vol_min() const { return vol_min_; }
+
+private:
+    double window_sec_;
+    double price_bp_;
+    double vol_min_;
+
+    struct PriceTick {
+        double timestamp;
+        double price;
+        double volume;
+    };
+
+    // 尚未结束的窗口共用一份缓冲：队首是最早的 base，所有窗口都延伸到队尾
+    RingBuffer<PriceTick> window_;
+    uint64_t head_seq_ = 0;          // window_[0] 的全局序号
+    RingBuffer<uint64_t> max_q_;     // 价格单调递减的序号队列，队首为区间最高价
+    RingBuffer<uint64_t> min_q_;     // 价格单调递增，队首为区间最低价
+    PriceVolumeTree by_price_;       // window_ 里的成交按 (价格, 序号) 排序
+
+    const PriceTick& at_seq(uint64_t seq) const {
+        return window_[static_cast<std::size_t>(seq - head_seq_)];
+    }
+
+    // 结算以队首为 base 的窗口并出队
+    void close_front();
+};
@@ -0,0 +1,159 @@
+// cpp/price_volume_tree.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// === 按价格有序的成交量集合：查询 价格 >= p / <= p 的成交量之和 ===
+// treap（随机优先级的二叉搜索树），键为 (price, seq)，同价的成交按 seq 区分，每笔成交一个节点
+// 节点保存子树成交量之和：插入 / 删除 / 查询均为期望 O(log n)
+// 子树和每次都由子节点重新相加，不做减法，不会随插删累积浮点误差
+// 节点放在数组里，删除的节点进空闲表复用，规模稳定后不再分配
+class PriceVolumeTree {
+public:
+    PriceVolumeTree() : nodes_(1) {}  // 0 号是空节点（sum = 0）
+
+    void insert(double price, uint64_t seq, double volume) {
+        uint32_t n = alloc(price, seq, volume);
+        uint32_t l, r;
+        split(root_, price, seq, l, r);
+        root_ = merge(merge(l, n), r);
+        ++size_;
+    }
+
+    // (price, seq) 必须在集合里
+    void erase(double price, uint64_t seq) {
+        uint32_t l, mid, r;
+        split(root_, price, seq, l, mid);      // l: < key
+        split(mid, price, seq + 1, mid, r);    // mid: == key
+        if (mid != 0) {
+            free_.push_back(mid);
+            --size_;
+        }
+        root_ = merge(l, r);
+    }
+
+    double sum_at_least(double p) const {
+        double s = 0.0;
+        for (uint32_t n = root_; n != 0;) {
+            const Node& x = nodes_[n];
+            if (x.price >= p) {
+                s += x.volume + nodes_[x.right].sum;
+                n = x.left;
+            } else {
+                n = x.right;
+            }
+        }
+        return s;
+    }
+
+    double sum_at_most(double p) const {
+        double s = 0.0;
+        for (uint32_t n = root_; n != 0;) {
+            const Node& x = nodes_[n];
+            if (x.price <= p) {
+                s += x.volume + nodes_[x.left].sum;
+                n = x.right;
+            } else {
+                n = x.left;
+            }
+        }
+        return s;
+    }
+
+    std::size_t size() const { return size_; }
+
+    void clear() {
+        nodes_.resize(1);
+        free_.clear();
+        root_ = 0;
+        size_ = 0;
+    }
+
+private:
+    struct Node {
+        double price = 0.0;
+        uint64_t seq = 0;
+        double volume = 0.0;
+        double sum = 0.0;      // 子树成交量之和
+        uint32_t prio = 0;
+        uint32_t left = 0;
+        uint32_t right = 0;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    uint32_t root_ = 0;
+    std::size_t size_ = 0;
+    uint32_t rng_ = 2463534242u;  // xorshift32，固定种子：结果可复现
+
+    uint32_t next_prio() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return rng_;
+    }
+
+    uint32_t alloc(double price, uint64_t seq, double volume) {
+        uint32_t n;
+        if (!free_.empty()) {
+            n = free_.back();
+            free_.pop_back();
+        } else {
+            n = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        Node& x = nodes_[n];
+        x.price = price;
+        x.seq = seq;
+        x.volume = volume;
+        x.sum = volume;
+        x.prio = next_prio();
+        x.left = 0;
+        x.right = 0;
+        return n;
+    }
+
+    void pull(uint32_t n) {
+        Node& x = nodes_[n];
+        x.sum = nodes_[x.left].sum + x.volume + nodes_[x.right].sum;
+    }
+
+    static bool less(const Node& x, double price, uint64_t seq) {
+        return x.price < price || (x.price == price && x.seq < seq);
+    }
+
+    // t 按键分成 l（< (price, seq)）和 r（>=）
+    void split(uint32_t t, double price, uint64_t seq, uint32_t& l, uint32_t& r) {
+        if (t == 0) {
+            l = r = 0;
+            return;
+        }
+        if (less(nodes_[t], price, seq)) {
+            uint32_t rest;
+            split(nodes_[t].right, price, seq, rest, r);
+            nodes_[t].right = rest;
+            l = t;
+        } else {
+            uint32_t rest;
+            split(nodes_[t].left, price, seq, l, rest);
+            nodes_[t].left = rest;
+            r = t;
+        }
+        pull(t);
+    }
+
+    // l 的键都小于 r 的键
+    uint32_t merge(uint32_t l, uint32_t r) {
+        if (l == 0) return r;
+        if (r == 0) return l;
+        if (nodes_[l].prio > nodes_[r].prio) {
+            nodes_[l].right = merge(nodes_[l].right, r);
+            pull(l);
+            return l;
+        }
+        nodes_[r].left = merge(l, nodes_[r].left);
+        pull(r);
+        return r;
+    }
+};
@@ -0,0 +1,95 @@
+// cpp/replay_engine.cpp
+#include "replay_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "trade_book_merge.h"
+
+namespace {
+
+FrameSchedule interval_schedule(double interval_sec) {
+    FrameSchedule s;
+    s.interval_sec = interval_sec;
+    return s;
+}
+
+}  // namespace
+
+ReplayEngine::ReplayEngine(const OrderFlowFeatureExtractor& extractor,
+                           const FrameSchedule& schedule)
+    : extractor_(extractor) {
+    if (!(schedule.interval_sec > 0.0) && schedule.every_n_trades <= 0) {
+        throw std::invalid_argument(
+            "ReplayEngine: schedule needs interval_sec > 0 or every_n_trades > 0");
+    }
+    extractor_.set_schedule(schedule);
+    extractor_.clear_scheduled_frames();
+}
+
+ReplayEngine::ReplayEngine(const OrderFlowFeatureExtractor& extractor, double frame_interval_sec)
+    : ReplayEngine(extractor, interval_schedule(frame_interval_sec)) {}
+
+void ReplayEngine::check_order(const double* trade_ts, std::size_t n_trades,
+                               const double* book_ts, std::size_t n_book) const {
+    bool ok = std::is_sorted(trade_ts, trade_ts + n_trades) && std::is_sorted(book_ts, book_ts + n_book);
+    if (ok && started_) {
+        ok = (n_trades == 0 || trade_ts[0] >= last_ts_) && (n_book == 0 || book_ts[0] >= last_ts_);
+    }
+    if (!ok) throw std::invalid_argument("ReplayEngine: input streams must be sorted by ts");
+}
+
+void ReplayEngine::run(const double* trade_ts, const double* trade_price,
+                       const double* trade_volume, const int8_t* trade_side,
+                       std::size_t n_trades,
+                       const double* book_ts, const double* book_price, const double* book_size,
+                       const int8_t* book_side, const uint8_t* book_flags, std::size_t n_book) {
+    if (n_trades == 0 && n_book == 0) return;
+    // 先整体检查排序（含与上一段的衔接）再动状态，出错时不会回放到一半
+    check_order(trade_ts, n_trades, book_ts, n_book);
+
+    // 定时帧按时间跨度预分配，回放过程中不再扩容
+    double interval = extractor_.schedule().interval_sec;
+    if (interval > 0.0) {
+        double first = n_trades == 0 ? book_ts[0]
+                     : n_book == 0   ? trade_ts[0]
+                                     : std::min(trade_ts[0], book_ts[0]);
+        double last = n_trades == 0 ? book_ts[n_book - 1]
+                    : n_book == 0   ? trade_ts[n_trades - 1]
+                                    : std::max(trade_ts[n_trades - 1], book_ts[n_book - 1]);
+        OrderFlowFrameColumns& out = extractor_.scheduled_frames();
+        if (last >= first) out.reserve(out.size() + static_cast<std::size_t>((last - first) / interval) + 2);
+    }
+
+    std::size_t frames_before = frames().size();
+    merge_trade_book(
+        trade_ts, n_trades, book_ts, book_price, book_size, book_side, book_flags, n_book,
+        bids_, asks_,
+        [&](std::size_t i) {
+            double ts = trade_ts[i];
+            last_ts_ = ts;
+            extractor_.add_trade(ts, trade_price[i], trade_volume[i],
+                                 trade_side[i] > 0 ? Side::Buy : Side::Sell);
+            ++stats_.trades;
+        },
+        [&](double ts, bool snapshot, std::size_t rows) {
+            last_ts_ = ts;
+            extractor_.advance_to(ts);
+            if (snapshot) {
+                extractor_.apply_l2_snapshot(bids_.data(), bids_.size() / 2,
+                                             asks_.data(), asks_.size() / 2);
+                ++stats_.snapshots;
+            } else {
+                extractor_.apply_l2_delta(bids_.data(), bids_.size() / 2,
+                                          asks_.data(), asks_.size() / 2);
+            }
+            stats_.book_rows += static_cast<int64_t>(rows);
+            ++stats_.book_messages;
+        });
+
+    started_ = true;
+    // 段末：<= 最后事件时间的定时帧都已确定
+    extractor_.advance_to(std::nextafter(last_ts_, INFINITY));
+    stats_.frames += static_cast<int64_t>(frames().size() - frames_before);
+}
@@ -0,0 +1,64 @@
+// cpp/replay_engine.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "orderflow_features.h"
+
+struct ReplayStats {
+    int64_t trades = 0;
+    int64_t book_rows = 0;
+    int64_t book_messages = 0;  // 其中 snapshot 的条数见 snapshots
+    int64_t snapshots = 0;
+    int64_t frames = 0;
+};
+
+// === 成交 + 盘口确定性回放：驱动 OrderFlowFeatureExtractor，按 FrameSchedule 出帧 ===
+// 输入两路列式流，各自按 ts 升序（秒）：
+//   成交：ts / price / volume / side（>0=Buy, 否则 Sell），同 Backtester::run
+//   盘口：每行一档 ts / price / size / side（>0=Bid, 否则 Ask；size<=0 删除该档）/ flags
+//         ts 相同的连续行为一条消息，一次 apply_l2_delta；
+//         flags 含 kRecordSnapshot 的行开始一条 snapshot 消息（先清空再 apply），flags 可为空
+// 两路按时间归并；同一时间戳上先成交、后盘口（盘口推送通常晚于撮合）
+// 出帧由提取器自己的调度完成（定时 / 每 N 笔），盘口消息前先 advance_to(ts)，
+// 所以 t 时刻的定时帧在所有 ts <= t 的事件之后计算；结果与调用方怎么分批无关
+// 出错（流未按时间排序 / 没有任何触发）抛 std::invalid_argument；排序在回放前整体检查，出错时状态不变
+class ReplayEngine {
+public:
+    ReplayEngine(const OrderFlowFeatureExtractor& extractor, const FrameSchedule& schedule);
+
+    // 只按固定间隔出帧
+    explicit ReplayEngine(const OrderFlowFeatureExtractor& extractor = OrderFlowFeatureExtractor(),
+                          double frame_interval_sec = 0.1);
+
+    // 可多次调用续跑：每段内部归并，段与段之间时间须不减；
+    // 段末会出完 <= 本段最后事件时间的定时帧，所以同一时间戳的事件不要拆到两段里
+    void run(const double* trade_ts, const double* trade_price, const double* trade_volume,
+             const int8_t* trade_side, std::size_t n_trades,
+             const double* book_ts, const double* book_price, const double* book_size,
+             const int8_t* book_side, const uint8_t* book_flags, std::size_t n_book);
+
+    // 已出的帧（提取器的调度输出）及触发原因
+    const OrderFlowFrameColumns& frames() const { return extractor_.scheduled_frames(); }
+    OrderFlowFrameColumns& frames() { return extractor_.scheduled_frames(); }
+    const std::vector<uint8_t>& triggers() const { return extractor_.scheduled_triggers(); }
+    std::vector<uint8_t>& triggers() { return extractor_.scheduled_triggers(); }
+
+    const ReplayStats& stats() const { return stats_; }
+    const OrderFlowFeatureExtractor& extractor() const { return extractor_; }
+    const FrameSchedule& schedule() const { return extractor_.schedule(); }
+
+private:
+    OrderFlowFeatureExtractor extractor_;
+    ReplayStats stats_;
+
+    bool   started_ = false;
+    double last_ts_ = 0.0;      // 已应用的最后事件时间（检查段与段的衔接）
+
+    std::vector<double> bids_;  // 一条盘口消息的 N×2 (price, size)，复用
+    std::vector<double> asks_;
+
+    void check_order(const double* trade_ts, std::size_t n_trades,
+                     const double* book_ts, std::size_t n_book) const;
+};
@@ -0,0 +1,79 @@
+// cpp/ring_buffer.h
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// 连续内存的环形队列：容量为 2 的幂，只有满时才翻倍扩容
+// 稳态下 push_back / pop_front 不分配内存，用来替代滑窗里的 std::deque
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t initial_capacity = 64)
+        : buf_(round_up_pow2(initial_capacity)),
+          mask_(buf_.size() - 1) {}
+
+    void push_back(const T& v) {
+        if (size_ == buf_.size()) grow();
+        buf_[(head_ + size_) & mask_] = v;
+        ++size_;
+    }
+
+    void pop_front() {
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+
+    // 一次丢弃队首 n 个（n <= size()）
+    void pop_front(std::size_t n) {
+        head_ = (head_ + n) & mask_;
+        size_ -= n;
+    }
+
+    void pop_back() { --size_; }
+
+    T& front() { return buf_[head_]; }
+    const T& front() const { return buf_[head_]; }
+    T& back() { return buf_[(head_ + size_ - 1) & mask_]; }
+    const T& back() const { return buf_[(head_ + size_ - 1) & mask_]; }
+
+    // i=0 为最旧元素
+    T& operator[](std::size_t i) { return buf_[(head_ + i) & mask_]; }
+    const T& operator[](std::size_t i) const { return buf_[(head_ + i) & mask_]; }
+
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return buf_.size(); }
+    bool empty() const { return size_ == 0; }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    // 预留容量（不会缩容）
+    void reserve(std::size_t n) {
+        while (buf_.size() < n) grow();
+    }
+
+private:
+    std::vector<T> buf_;
+    std::size_t mask_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t cap = 1;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    void grow() {
+        std::vector<T> next(buf_.size() * 2);
+        for (std::size_t i = 0; i < size_; ++i) {
+            next[i] = std::move((*this)[i]);
+        }
+        buf_.swap(next);
+        mask_ = buf_.size() - 1;
+        head_ = 0;
+    }
+};
@@ -0,0 +1,105 @@
+// cpp/spsc_queue.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// 避免生产 / 消费两端的下标落在同一缓存行
+constexpr std::size_t kCacheLine = 64;
+
+// === 有界无锁单生产者 / 单消费者队列 ===
+// 容量向上取 2 的幂；槽位一次性分配、反复复用（槽里的 std::string 等保留 capacity）
+// 生产端：try_reserve() 拿到空槽原地填写后 commit()，或直接 try_push()
+// 消费端：front() 原地读取后 pop()，或直接 try_pop()
+// 两端各自只能有一个线程；size() 只是近似值（给监控用）
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity = 1024) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // ---- 生产端 ----
+
+    T* try_reserve() {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) return nullptr;
+        }
+        return &slots_[tail & mask_];
+    }
+
+    void commit() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_push(const T& v) {
+        T* slot = try_reserve();
+        if (!slot) return false;
+        *slot = v;
+        commit();
+        return true;
+    }
+
+    // 全部放得下才写入，一次发布（一条消息拆出的多条记录不会只进去一半）
+    bool try_push_n(const T* v, std::size_t n) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail + n - head_cache_ > mask_ + 1) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail + n - head_cache_ > mask_ + 1) return false;
+        }
+        for (std::size_t i = 0; i < n; ++i) slots_[(tail + i) & mask_] = v[i];
+        tail_.store(tail + n, std::memory_order_release);
+        return true;
+    }
+
+    // ---- 消费端 ----
+
+    T* front() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_pop(T& out) {
+        T* slot = front();
+        if (!slot) return false;
+        out = *slot;
+        pop();
+        return true;
+    }
+
+    // ---- 任意线程 ----
+
+    std::size_t size() const {
+        // 先读 head：之后读到的 tail 一定不小于它
+        std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+    bool empty() const { return size() == 0; }
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};  // 消费端写
+    std::size_t tail_cache_ = 0;                             // 消费端看到的 tail
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};  // 生产端写
+    std::size_t head_cache_ = 0;                             // 生产端看到的 head
+};
@@ -0,0 +1,122 @@
+// cpp/state_io.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ring_buffer.h"
+
+// === 状态快照的二进制读写（热备接管 / pickle）===
+// 布局：magic[4] + uint32 版本，之后是各对象自己按固定顺序写的字段
+// 只写 POD，字节序为本机字节序（与 tick_store 一致，不跨架构）
+// 读越界、magic 或版本不符时抛 std::runtime_error
+
+// 2：提取器极值改为分桶结构；3：SweepModel 加 EWMA 基线；4：sweep 事件逐字段写出、不含填充
+constexpr uint32_t kStateVersion = 4;
+
+class StateWriter {
+public:
+    StateWriter(const char (&magic)[5]) {
+        buf_.append(magic, 4);
+        put(kStateVersion);
+    }
+
+    template <typename T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "state fields must be POD");
+        buf_.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    void put_vector(const std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "state fields must be POD");
+        put(static_cast<uint64_t>(v.size()));
+        buf_.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    }
+
+    // 从旧到新
+    template <typename T>
+    void put_ring(const RingBuffer<T>& rb) {
+        put(static_cast<uint64_t>(rb.size()));
+        for (std::size_t i = 0; i < rb.size(); ++i) put(rb[i]);
+    }
+
+    const std::string& bytes() const { return buf_; }
+    std::string take() { return std::move(buf_); }
+
+private:
+    std::string buf_;
+};
+
+class StateReader {
+public:
+    StateReader(const std::string& data, const char (&magic)[5])
+        : p_(data.data()), end_(data.data() + data.size()) {
+        if (data.size() < 8 || std::memcmp(p_, magic, 4) != 0) {
+            throw std::runtime_error(std::string("state: not a ") + magic + " snapshot");
+        }
+        p_ += 4;
+        uint32_t version = get<uint32_t>();
+        if (version != kStateVersion) {
+            throw std::runtime_error("state: unsupported version " + std::to_string(version));
+        }
+    }
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "state fields must be POD");
+        if constexpr (std::is_same<T, bool>::value) {
+            return get<uint8_t>() != 0;  // 损坏的字节不能直接当 bool 用
+        } else {
+            need(sizeof(T));
+            T v;
+            std::memcpy(&v, p_, sizeof(T));
+            p_ += sizeof(T);
+            return v;
+        }
+    }
+
+    template <typename T>
+    void get_vector(std::vector<T>& out) {
+        std::size_t n = count(sizeof(T));
+        out.resize(n);
+        std::memcpy(out.data(), p_, n * sizeof(T));
+        p_ += n * sizeof(T);
+    }
+
+    template <typename T>
+    void get_ring(RingBuffer<T>& rb) {
+        std::size_t n = count(sizeof(T));
+        rb.clear();
+        rb.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) rb.push_back(get<T>());
+    }
+
+    // 读完后调用：多余的字节说明格式对不上
+    void finish() const {
+        if (p_ != end_) throw std::runtime_error("state: trailing bytes in snapshot");
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+
+    void need(std::size_t n) const {
+        if (static_cast<std::size_t>(end_ - p_) < n) {
+            throw std::runtime_error("state: truncated snapshot");
+        }
+    }
+
+    // 元素个数（先校验剩余字节够不够，防止损坏的长度字段导致巨量分配）
+    std::size_t count(std::size_t elem_size) {
+        uint64_t n = get<uint64_t>();
+        if (n > static_cast<uint64_t>(end_ - p_) / elem_size) {
+            throw std::runtime_error("state: truncated snapshot");
+        }
+        return static_cast<std::size_t>(n);
+    }
+};
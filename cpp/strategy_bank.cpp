@@ -0,0 +1,175 @@
+// cpp/strategy_bank.cpp
+#include "strategy_bank.h"
+
+#include <stdexcept>
+
+#include "state_io.h"
+
+namespace {
+constexpr char kBankStateMagic[5] = "MRBK";
+}  // namespace
+
+std::size_t StrategyBank::add(const MeanReversionStrategy& s) {
+    delay_ms_.push_back(s.delay_ms);
+    hold_sec_.push_back(s.hold_sec);
+    tp_bp_.push_back(s.tp_bp);
+    sl_bp_.push_back(s.sl_bp);
+    bool open = s.in_position && s.pos_dir != 0;
+    pos_dir_.push_back(open ? static_cast<double>(s.pos_dir) : 0.0);
+    entry_price_.push_back(open ? s.entry_price : 0.0);
+    entry_ts_.push_back(open ? s.entry_ts : 0.0);
+    if (open) ++n_open_;
+    close_mask_.push_back(0.0);
+    stats_.emplace_back();
+    return size() - 1;
+}
+
+void StrategyBank::add_product(const std::vector<double>& delays_ms,
+                               const std::vector<double>& holds_sec,
+                               const std::vector<double>& tps_bp,
+                               const std::vector<double>& sls_bp) {
+    for (double dl : delays_ms)
+    for (double hd : holds_sec)
+    for (double tp : tps_bp)
+    for (double sl : sls_bp) {
+        add(MeanReversionStrategy(dl, hd, tp, sl));
+    }
+}
+
+MeanReversionStrategy StrategyBank::strategy(std::size_t i) const {
+    if (i >= size()) throw std::out_of_range("StrategyBank: index out of range");
+    MeanReversionStrategy s(delay_ms_[i], hold_sec_[i], tp_bp_[i], sl_bp_[i]);
+    s.in_position = pos_dir_[i] != 0.0;
+    s.pos_dir = static_cast<int>(pos_dir_[i]);
+    s.entry_price = entry_price_[i];
+    s.entry_ts = entry_ts_[i];
+    return s;
+}
+
+void StrategyBank::open(std::size_t i, int dir, double price, double ts) {
+    pos_dir_[i] = dir;
+    entry_price_[i] = price;
+    entry_ts_[i] = ts;
+    ++n_open_;
+    ++stats_[i].opens;
+
+    StrategyActionType type = dir > 0 ? StrategyActionType::OpenLong : StrategyActionType::OpenShort;
+    actions_.push_back({ts, price, 0.0, static_cast<int32_t>(i), static_cast<int32_t>(type), dir});
+}
+
+void StrategyBank::close(std::size_t i, double price, double ts) {
+    int dir = static_cast<int>(pos_dir_[i]);
+    double entry = entry_price_[i];
+    double pnl_bp = (price - entry) / entry * 10000.0 * dir;
+
+    BankStats& st = stats_[i];
+    st.cum_pnl_bp += pnl_bp;
+    if (pnl_bp > 0.0) {
+        ++st.wins;
+    } else if (pnl_bp < 0.0) {
+        ++st.losses;
+    }
+    ++st.closes;
+
+    pos_dir_[i] = 0.0;
+    entry_price_[i] = 0.0;
+    entry_ts_[i] = 0.0;
+    --n_open_;
+
+    actions_.push_back({ts, price, pnl_bp, static_cast<int32_t>(i),
+                        static_cast<int32_t>(StrategyActionType::Close), dir});
+}
+
+// 逐个策略同 MeanReversionStrategy::on_sweep；sweep 很少，不做向量化
+const std::vector<BankAction>& StrategyBank::on_sweep(const SweepEventMeta& ev) {
+    actions_.clear();
+    const std::size_t n = size();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (pos_dir_[i] != 0.0) {
+            // 原方向的第二次 sweep 视为延续，止损平仓
+            if (ev.direction != 0 && ev.direction == -static_cast<int>(pos_dir_[i])) {
+                close(i, ev.price_end, ev.ts_end);
+            }
+            continue;
+        }
+        if (ev.direction == 0) continue;
+
+        double delay_sec = delay_ms_[i] / 1000.0;
+        double ts_enter = ev.ts_end + delay_sec;
+        open(i, ev.direction > 0 ? -1 : 1, ev.price_end, ts_enter);
+    }
+    return actions_;
+}
+
+const std::vector<BankAction>& StrategyBank::on_tick(double ts, double price) {
+    actions_.clear();
+    if (n_open_ == 0) return actions_;
+
+    // 第一遍：整列算平仓条件，结果写成 0 / 非 0 的 double（条件都用 double 选择，-O3 下可向量化）
+    // 空仓的列 entry_price 为 0，ret 无意义，由 dir != 0 屏蔽
+    // 与单实例的比较逐位相同：ret * dir 对 ±1 是精确的，-(ret * dir) 即另一侧
+    const std::size_t n = size();
+    const double* __restrict dir = pos_dir_.data();
+    const double* __restrict entry = entry_price_.data();
+    const double* __restrict entry_ts = entry_ts_.data();
+    const double* __restrict tp = tp_bp_.data();
+    const double* __restrict sl = sl_bp_.data();
+    const double* __restrict hold = hold_sec_.data();
+    double* __restrict mask = close_mask_.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        double ret = (price - entry[i]) / entry[i] * 10000.0 * dir[i];  // 按持仓方向的收益
+        double take = ret >= tp[i] ? 1.0 : 0.0;
+        double stop = -ret >= sl[i] ? 1.0 : 0.0;
+        double timeout = ts - entry_ts[i] >= hold[i] ? 1.0 : 0.0;
+        double open = dir[i] != 0.0 ? 1.0 : 0.0;
+        mask[i] = open * (take + stop + timeout);
+    }
+
+    // 第二遍：只对触发的列平仓
+    for (std::size_t i = 0; i < n; ++i) {
+        if (mask[i] != 0.0) close(i, price, ts);
+    }
+    return actions_;
+}
+
+std::string StrategyBank::serialize() const {
+    StateWriter w(kBankStateMagic);
+    w.put_vector(delay_ms_);
+    w.put_vector(hold_sec_);
+    w.put_vector(tp_bp_);
+    w.put_vector(sl_bp_);
+    w.put_vector(pos_dir_);
+    w.put_vector(entry_price_);
+    w.put_vector(entry_ts_);
+    w.put_vector(stats_);
+    return w.take();
+}
+
+StrategyBank StrategyBank::deserialize(const std::string& data) {
+    StateReader r(data, kBankStateMagic);
+    StrategyBank b;
+    r.get_vector(b.delay_ms_);
+    r.get_vector(b.hold_sec_);
+    r.get_vector(b.tp_bp_);
+    r.get_vector(b.sl_bp_);
+    r.get_vector(b.pos_dir_);
+    r.get_vector(b.entry_price_);
+    r.get_vector(b.entry_ts_);
+    r.get_vector(b.stats_);
+    r.finish();
+
+    const std::size_t n = b.delay_ms_.size();
+    if (b.hold_sec_.size() != n || b.tp_bp_.size() != n || b.sl_bp_.size() != n ||
+        b.pos_dir_.size() != n || b.entry_price_.size() != n || b.entry_ts_.size() != n ||
+        b.stats_.size() != n) {
+        throw std::runtime_error("state: corrupt strategy bank columns");
+    }
+    for (double d : b.pos_dir_) {
+        if (d != 0.0 && d != 1.0 && d != -1.0) {
+            throw std::runtime_error("state: corrupt strategy bank position");
+        }
+        if (d != 0.0) ++b.n_open_;
+    }
+    b.close_mask_.assign(n, 0.0);
+    return b;
+}
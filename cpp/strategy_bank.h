@@ -0,0 +1,81 @@
+// cpp/strategy_bank.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mean_reversion_strategy.h"
+#include "sweep_model.h"
+
+// StrategyBank 产生的一条动作（Idle 不输出）
+struct BankAction {
+    double  ts;
+    double  price;
+    double  pnl_bp;  // Close：本笔按方向的收益（bp），口径同 TradeRecord；Open 为 0
+    int32_t index;   // 策略下标（添加顺序）
+    int32_t type;    // StrategyActionType
+    int32_t dir;     // 1=long, -1=short
+};
+
+// 每个策略的影子统计，口径同 BacktestStats
+struct BankStats {
+    int64_t opens = 0;
+    int64_t closes = 0;
+    int64_t wins = 0;
+    int64_t losses = 0;
+    double  cum_pnl_bp = 0.0;
+};
+
+// === 多组 MeanReversionStrategy 参数对同一路 sweep 事件 / 成交的影子运行 ===
+// 每个策略的行为与单独一个 MeanReversionStrategy 逐位一致（同样的 on_sweep / on_tick 序列）
+// 参数和持仓按列（SoA）存放，on_tick 一次循环检查所有持仓的止盈 / 止损 / 持仓时间，
+// 无分支、可向量化；没有持仓时直接返回
+// on_sweep / on_tick 返回本次调用产生的动作，引用在下一次调用前有效
+class StrategyBank {
+public:
+    // 拷贝参数和当前持仓，返回下标
+    std::size_t add(const MeanReversionStrategy& strategy);
+
+    // 笛卡尔积展开，顺序与嵌套循环一致（最后一个维度变化最快），同 ParamGrid
+    void add_product(const std::vector<double>& delays_ms,
+                     const std::vector<double>& holds_sec,
+                     const std::vector<double>& tps_bp,
+                     const std::vector<double>& sls_bp);
+
+    std::size_t size() const { return delay_ms_.size(); }
+    std::size_t open_positions() const { return n_open_; }
+
+    // 第 i 个策略（参数 + 持仓）的单实例拷贝
+    MeanReversionStrategy strategy(std::size_t i) const;
+
+    const std::vector<BankAction>& on_sweep(const SweepEventMeta& ev);
+    const std::vector<BankAction>& on_tick(double ts, double price);
+
+    const std::vector<BankAction>& actions() const { return actions_; }
+    const std::vector<BankStats>& stats() const { return stats_; }
+
+    // 状态快照（参数 + 持仓 + 统计），用于热备接管 / pickle
+    std::string serialize() const;
+    static StrategyBank deserialize(const std::string& data);
+
+private:
+    // 参数
+    std::vector<double> delay_ms_;
+    std::vector<double> hold_sec_;
+    std::vector<double> tp_bp_;
+    std::vector<double> sl_bp_;
+
+    // 持仓：pos_dir_ 为 0 / ±1（用 double 与其余列一起向量化），空仓时 entry_* 为 0
+    std::vector<double> pos_dir_;
+    std::vector<double> entry_price_;
+    std::vector<double> entry_ts_;
+    std::size_t n_open_ = 0;
+
+    std::vector<double> close_mask_;  // on_tick 的临时结果（非 0 为平仓），复用
+    std::vector<BankStats> stats_;
+    std::vector<BankAction> actions_;
+
+    void open(std::size_t i, int dir, double price, double ts);
+    void close(std::size_t i, double price, double ts);
+};
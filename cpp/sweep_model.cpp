@@ -1,141 +1,38 @@
 // cpp/sweep_model.cpp
 #include "sweep_model.h"
 
-SweepModel::SweepModel(double short_window_sec,
-                       double long_window_sec,
-                       double threshold_ratio)
-    : short_win_(short_window_sec),
-      long_win_(long_window_sec),
-      threshold_ratio_(threshold_ratio),
-      short_buy_vol_(0.0),
-      short_sell_vol_(0.0),
-      long_buy_vol_(0.0),
-      long_sell_vol_(0.0),
-      in_sweep_(false),
-      last_sweep_ts_(0.0),
-      last_price_(0.0),
-      has_last_price_(false)
-{
-    last_event_.ts_start    = 0.0;
-    last_event_.ts_end      = 0.0;
-    last_event_.price_start = 0.0;
-    last_event_.price_end   = 0.0;
-    last_event_.volume_total = 0.0;
-    last_event_.direction   = 0;
+template class SweepModelT<RuntimeSweepPolicy>;
+
+SweepModel SweepModel::deserialize(const std::string& data) {
+    // 先读出参数构造对象，再整体 restore（restore 会重新校验一遍 magic / 参数）
+    StateReader r(data, kStateMagic);
+    double short_win = r.get<double>();
+    double long_win = r.get<double>();
+    double threshold = r.get<double>();
+    r.get<double>();  // dominance / rearm_ratio 是常量，restore 里校验
+    r.get<double>();
+    int32_t baseline = r.get<int32_t>();
+    if (baseline < 0 || baseline > static_cast<int32_t>(SweepBaseline::EwmaZ)) {
+        throw std::runtime_error("state: corrupt sweep baseline");
+    }
+    SweepModel model(short_win, long_win, threshold, static_cast<SweepBaseline>(baseline));
+    model.restore(data);
+    return model;
 }
 
-void SweepModel::evict_old(double current_ts) {
-    // 移出 long_window 之外的 tick，并更新 long_* 统计
-    while (!window_long_.empty() &&
-           current_ts - window_long_.front().timestamp > long_win_) {
-        const Tick& t = window_long_.front();
-        double vol = t.volume;
-        if (t.side == Side::Buy) {
-            long_buy_vol_  -= vol;
-        } else {
-            long_sell_vol_ -= vol;
+void SweepDetector::process_ticks(const double* ts,
+                                  const double* price,
+                                  const double* volume,
+                                  const int8_t* side,
+                                  std::size_t n,
+                                  int8_t* signals_out,
+                                  std::vector<SweepEventMeta>* events_out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        Tick t{ts[i], price[i], volume[i], side[i] > 0 ? Side::Buy : Side::Sell};
+        SweepSignal sig = process_tick(t);
+        signals_out[i] = static_cast<int8_t>(sig);
+        if (events_out) {
+            events_out->insert(events_out->end(), events_.begin(), events_.end());
         }
-        window_long_.pop_front();
     }
-
-    // 移出 short_window 之外的 tick，更新 short_* 统计
-    while (!window_short_.empty() &&
-           current_ts - window_short_.front().timestamp > short_win_) {
-        const Tick& t = window_short_.front();
-        double vol = t.volume;
-        if (t.side == Side::Buy) {
-            short_buy_vol_ -= vol;
-        } else {
-            short_sell_vol_ -= vol;
-        }
-        window_short_.pop_front();
-    }
-}
-
-SweepSignal SweepModel::process_tick(const Tick& tick) {
-    double ts = tick.timestamp;
-
-    // 先驱逐过期 tick
-    evict_old(ts);
-
-    // 更新 last_price_（用上一个 tick 的 price）
-    if (!has_last_price_) {
-        last_price_ = tick.price;
-        has_last_price_ = true;
-    }
-
-    // 将当前 tick 加入窗口并更新统计量
-    window_long_.push_back(tick);
-    window_short_.push_back(tick);
-    double vol = tick.volume;
-    if (tick.side == Side::Buy) {
-        short_buy_vol_ += vol;
-        long_buy_vol_  += vol;
-    } else {
-        short_sell_vol_ += vol;
-        long_sell_vol_  += vol;
-    }
-
-    double short_total = short_buy_vol_ + short_sell_vol_;
-    double long_total  = long_buy_vol_  + long_sell_vol_;
-    if (long_total <= 0.0) {
-        last_price_ = tick.price;
-        return SweepSignal::NoSignal;
-    }
-
-    // “短期量 / 长期平均量”的粗近似
-    double expected_short = (long_total / long_win_) * short_win_;
-    if (expected_short <= 0.0) {
-        last_price_ = tick.price;
-        return SweepSignal::NoSignal;
-    }
-    double ratio = short_total / expected_short;
-
-    // 当 ratio 明显回落，允许下一次 sweep
-    if (ratio < threshold_ratio_ * 0.5) {
-        in_sweep_ = false;
-    }
-
-    // 已处于 sweep 状态：不再重复触发
-    if (in_sweep_) {
-        last_price_ = tick.price;
-        return SweepSignal::NoSignal;
-    }
-
-    // 只在 ratio 第一次跨越阈值时触发事件
-    if (ratio >= threshold_ratio_) {
-        // 进入 sweep 状态
-        in_sweep_ = true;
-        last_sweep_ts_ = ts;
-
-        // 判断方向
-        SweepSignal sig = SweepSignal::NoSignal;
-        double buy = short_buy_vol_;
-        double sell = short_sell_vol_;
-
-        if (buy > sell * 1.5) {
-            sig = SweepSignal::UpSweep;
-            last_event_.direction = 1;
-        } else if (sell > buy * 1.5) {
-            sig = SweepSignal::DownSweep;
-            last_event_.direction = -1;
-        } else {
-            last_event_.direction = 0;
-        }
-
-        if (sig != SweepSignal::NoSignal) {
-            // 填充事件元信息
-            last_event_.ts_end      = ts;
-            last_event_.ts_start    = ts - short_win_;    // 近似窗口起点
-            last_event_.price_end   = tick.price;
-            last_event_.price_start = has_last_price_ ? last_price_ : tick.price;
-            last_event_.volume_total = short_total;
-        }
-
-        last_price_ = tick.price;
-        return sig;
-    }
-
-    last_price_ = tick.price;
-    return SweepSignal::NoSignal;
 }
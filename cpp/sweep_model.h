@@ -1,6 +1,16 @@
 // cpp/sweep_model.h
 #pragma once
-#include <deque>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "latency.h"
+#include "ring_buffer.h"
+#include "state_io.h"
 
 enum class Side {
     Buy = 1,
@@ -30,42 +40,504 @@ struct SweepEventMeta {
     int    direction;    // 1=Up, -1=Down
 };
 
-class SweepModel {
+// 快照里逐字段读写（结构体带尾部填充，不整体写出）
+inline void put_event(StateWriter& w, const SweepEventMeta& ev) {
+    w.put(ev.ts_start);
+    w.put(ev.ts_end);
+    w.put(ev.price_start);
+    w.put(ev.price_end);
+    w.put(ev.volume_total);
+    w.put(static_cast<int32_t>(ev.direction));
+}
+
+inline SweepEventMeta get_event(StateReader& r) {
+    SweepEventMeta ev;
+    ev.ts_start = r.get<double>();
+    ev.ts_end = r.get<double>();
+    ev.price_start = r.get<double>();
+    ev.price_end = r.get<double>();
+    ev.volume_total = r.get<double>();
+    ev.direction = r.get<int32_t>();
+    return ev;
+}
+
+// === sweep 检测器公共接口：Backtester / ParamGrid 按接口持有，检测算法可以替换 ===
+// 流式语义：每条 tick 调一次 process_tick；一条 tick 可能同时确认多个事件，
+// 本次调用确认的全部事件按顺序放在 tick_events() 里
+class SweepDetector {
 public:
-    SweepModel(double short_window_sec = 0.3,   // 典型 sweep 时间窗：0.1~0.5s
-               double long_window_sec  = 10.0,  // 长期参考：几秒到几十秒
-               double threshold_ratio  = 3.0);
+    virtual ~SweepDetector() = default;
 
-    // 喂一条 tick，若触发 sweep，则返回 UpSweep/DownSweep，否则 NoSignal
-    SweepSignal process_tick(const Tick& tick);
+    // 喂一条 tick；返回本 tick 最后一个事件的方向，无事件时 NoSignal
+    virtual SweepSignal process_tick(const Tick& tick) = 0;
+
+    // 数据结束：结算还没确认的事件（结果同样放进 tick_events）；默认没有待结算的
+    virtual SweepSignal flush() {
+        events_.clear();
+        return SweepSignal::NoSignal;
+    }
+
+    virtual std::unique_ptr<SweepDetector> clone() const = 0;
+
+    // 最近一次 process_tick / flush 确认的事件
+    const std::vector<SweepEventMeta>& tick_events() const { return events_; }
 
     // 返回最近一次触发的 sweep 事件信息（若无，direction=0）
     SweepEventMeta get_last_event() const { return last_event_; }
 
+    // 批量喂 tick（列式输入，side: >0=Buy, 否则 Sell）
+    // signals_out[i] 写入第 i 条 tick 的信号；触发的事件按顺序追加到 events_out
+    void process_ticks(const double* ts,
+                       const double* price,
+                       const double* volume,
+                       const int8_t* side,
+                       std::size_t n,
+                       int8_t* signals_out,
+                       std::vector<SweepEventMeta>* events_out);
+
+protected:
+    std::vector<SweepEventMeta> events_;
+    SweepEventMeta last_event_{};
+
+    static SweepSignal last_signal(const std::vector<SweepEventMeta>& events) {
+        return events.empty() ? SweepSignal::NoSignal
+                              : static_cast<SweepSignal>(events.back().direction);
+    }
+};
+
+// 短窗口成交量的基线（期望量）怎么估
+enum class SweepBaseline : int32_t {
+    Window = 0,  // 长窗口里存下全部 tick：long_window_sec 内的平均量
+    Ewma   = 1,  // 时间衰减 EWMA 成交速率，时间常数 long_window_sec，不存 tick
+    EwmaZ  = 2   // 同 Ewma，但按 z-score 触发：threshold_ratio 解释为 z 阈值
+};
+
+// === 成交量比值型 sweep 检测 ===
+// 短窗口成交量 / 基线期望量 >= threshold_ratio 时触发，方向看短窗口买卖量谁占优
+//
+// 参数来自 Policy，需提供（static constexpr 或成员函数均可）：
+//   short_window_sec() / long_window_sec() / threshold_ratio()
+//   baseline()    见 SweepBaseline
+//   dominance()   方向判定：buy > sell * dominance 记 Up，反之记 Down
+//   rearm_ratio() ratio 回落到 threshold_ratio * rearm_ratio 以下才允许下一次触发
+// EWMA 基线：买卖两侧各一个衰减累计量 Σ v·e^{-Δt/τ}，除以同样衰减的已覆盖时长得到速率，
+// 期望量 = 速率 × short_window_sec；开头不足一个短窗口时不判断（预热）
+// EwmaZ 另记 偏差 = 短窗口量 − 期望量 的时间衰减均方，score = 偏差 / 其均方根，
+// 当前 tick 的偏差在打分之后才计入方差
+// 两种 EWMA 基线只保留短窗口内的 tick（内存随短窗口成交数增长），与 long_window_sec 无关，
+// 所以基线可以取到分钟 / 小时级；Window 基线则要保留整个长窗口的 tick
+// Policy 全部是编译期常量时（见 FixedSweepPolicy），热路径里的参数都折成立即数；
+// 运行期可调的 SweepModel 只是 RuntimeSweepPolicy 的一个实例化
+// process_tick 是 final：按具体类型调用（BybitFeedHandler 等）不走虚函数，可以整体内联
+template <typename Policy>
+class SweepModelT : public SweepDetector, private Policy {
+public:
+    explicit SweepModelT(const Policy& policy = Policy()) : Policy(policy) {}
+
+    // 喂一条 tick，若触发 sweep，则返回 UpSweep/DownSweep，否则 NoSignal
+    SweepSignal process_tick(const Tick& tick) final;
+
+    std::unique_ptr<SweepDetector> clone() const override {
+        return std::make_unique<SweepModelT>(*this);
+    }
+
+    const Policy& policy() const { return *this; }
+
+    // 状态快照（参数 + 窗口 tick + EWMA 基线 + 去抖状态），用于热备接管 / pickle
+    // restore 要求快照里的参数与本对象的 Policy 一致，否则抛 std::invalid_argument
+    std::string serialize() const;
+    void restore(const std::string& data);
+
+    static constexpr char kStateMagic[5] = "SWMD";
+
 private:
-    double short_win_;
-    double long_win_;
-    double threshold_ratio_;
+    // 窗口里只需要 ts / volume / 买卖下标（0=Buy, 1=Sell，直接索引成交量数组，不按 side 分支）
+    struct WindowTick {
+        double  timestamp;
+        double  volume;
+        uint8_t slot;
+    };
+
+    static uint8_t slot_of(Side side) {
+        return static_cast<uint8_t>((1 - static_cast<int>(side)) >> 1);
+    }
+
+    // 长短窗口共用一份 tick 缓冲，各自只是一个起点游标：
+    // [long_begin_, size) 为最近 long_window_sec，[short_begin_, size) 为最近 short_window_sec
+    // 两个游标都越过的 tick 才从队首弹出；以后加更多短周期只需再加游标
+    // EWMA 基线下 long_* 不用，long_begin_ 跟着 short_begin_ 走
+    RingBuffer<WindowTick> window_;
+    std::size_t long_begin_ = 0;
+    std::size_t short_begin_ = 0;
 
-    // 两层窗口：长窗口用于基线，短窗口用于即时爆发
-    std::deque<Tick> window_long_;   // 保存最近 long_window_sec 内的 tick
-    std::deque<Tick> window_short_;  // 保存最近 short_window_sec 内的 tick
+    double short_vol_[2] = {0.0, 0.0};  // [Buy, Sell]
+    double long_vol_[2]  = {0.0, 0.0};
 
-    double short_buy_vol_;
-    double short_sell_vol_;
-    double long_buy_vol_;
-    double long_sell_vol_;
+    // EWMA 基线（baseline() != Window）
+    bool   ewma_started_ = false;
+    double ewma_t0_ = 0.0;              // 第一条 tick 的时间
+    double ewma_ts_ = 0.0;              // 上次衰减到的时间
+    double rate_vol_[2] = {0.0, 0.0};   // [Buy, Sell] 衰减累计量
+    double rate_span_ = 0.0;            // 衰减后的已覆盖时长 τ(1 - e^{-elapsed/τ})
+    double dev_ = 0.0;                  // 上一条 tick 的偏差（EwmaZ）
+    bool   has_dev_ = false;
+    double dev_sq_ = 0.0;               // 偏差平方的衰减累计、对应权重
+    double dev_weight_ = 0.0;
 
     // 去抖/状态
-    bool   in_sweep_;
-    double last_sweep_ts_;
+    bool   in_sweep_ = false;
+    double last_sweep_ts_ = 0.0;
 
     // 上一个价格（用于估计 price_start）
-    double last_price_;
-    bool   has_last_price_;
-
-    // 最近一次触发的 sweep 事件
-    SweepEventMeta last_event_;
+    double last_price_ = 0.0;
+    bool   has_last_price_ = false;
 
     void evict_old(double current_ts);
+    // EWMA 基线：计入当前 tick，算出 score；预热中 / 基线为 0 时返回 false
+    bool ewma_score(double ts, uint8_t slot, double volume, double short_total, double& score);
 };
+
+// 运行期参数（Python / 参数网格用）；dominance / rearm 仍是常量
+class RuntimeSweepPolicy {
+public:
+    RuntimeSweepPolicy(double short_window_sec = 0.3,
+                       double long_window_sec  = 10.0,
+                       double threshold_ratio  = 3.0,
+                       SweepBaseline baseline  = SweepBaseline::Window)
+        : short_win_(short_window_sec),
+          long_win_(long_window_sec),
+          threshold_ratio_(threshold_ratio),
+          baseline_(baseline) {}
+
+    double short_window_sec() const { return short_win_; }
+    double long_window_sec() const { return long_win_; }
+    double threshold_ratio() const { return threshold_ratio_; }
+    SweepBaseline baseline() const { return baseline_; }
+    static constexpr double dominance() { return 1.5; }
+    static constexpr double rearm_ratio() { return 0.5; }
+
+private:
+    double short_win_;
+    double long_win_;
+    double threshold_ratio_;
+    SweepBaseline baseline_;
+};
+
+// 编译期固定参数（double 不能做模板实参，按毫秒 / 百分比传入）
+// 例：SweepModelT<FixedSweepPolicy<300, 10000, 300>> 等价于 SweepModel(0.3, 10.0, 3.0)
+template <int ShortMs, int LongMs, int ThresholdPct, int DominancePct = 150, int RearmPct = 50,
+          SweepBaseline Baseline = SweepBaseline::Window>
+struct FixedSweepPolicy {
+    static_assert(ShortMs > 0 && LongMs > 0, "windows must be positive");
+    static constexpr double short_window_sec() { return ShortMs / 1000.0; }
+    static constexpr double long_window_sec() { return LongMs / 1000.0; }
+    static constexpr double threshold_ratio() { return ThresholdPct / 100.0; }
+    static constexpr double dominance() { return DominancePct / 100.0; }
+    static constexpr double rearm_ratio() { return RearmPct / 100.0; }
+    static constexpr SweepBaseline baseline() { return Baseline; }
+};
+
+// 原有的运行期接口
+class SweepModel : public SweepModelT<RuntimeSweepPolicy> {
+public:
+    SweepModel(double short_window_sec = 0.3,   // 典型 sweep 时间窗：0.1~0.5s
+               double long_window_sec  = 10.0,  // 长期参考：几秒到几十秒
+               double threshold_ratio  = 3.0,
+               SweepBaseline baseline  = SweepBaseline::Window)  // Ewma 时 long_window_sec 为时间常数
+        : SweepModelT(::RuntimeSweepPolicy(short_window_sec, long_window_sec, threshold_ratio,
+                                           baseline)) {}
+
+    std::unique_ptr<SweepDetector> clone() const override {
+        return std::make_unique<SweepModel>(*this);
+    }
+
+    // 按快照里的参数构造并恢复状态
+    static SweepModel deserialize(const std::string& data);
+};
+
+// ---------------- SweepModelT 实现 ----------------
+
+template <typename Policy>
+void SweepModelT<Policy>::evict_old(double current_ts) {
+    const double long_win = Policy::long_window_sec();
+    const double short_win = Policy::short_window_sec();
+
+    // 长窗口游标前移，移出 long_window 的 tick 从 long_* 统计里扣掉
+    while (Policy::baseline() == SweepBaseline::Window && long_begin_ < window_.size() &&
+           current_ts - window_[long_begin_].timestamp > long_win) {
+        const WindowTick& t = window_[long_begin_];
+        long_vol_[t.slot] -= t.volume;
+        ++long_begin_;
+    }
+
+    // 短窗口游标前移，更新 short_* 统计
+    while (short_begin_ < window_.size() &&
+           current_ts - window_[short_begin_].timestamp > short_win) {
+        const WindowTick& t = window_[short_begin_];
+        short_vol_[t.slot] -= t.volume;
+        ++short_begin_;
+    }
+    if (Policy::baseline() != SweepBaseline::Window) long_begin_ = short_begin_;
+
+    // 两个窗口都不再需要的 tick 出队
+    std::size_t drop = long_begin_ < short_begin_ ? long_begin_ : short_begin_;
+    if (drop > 0) {
+        window_.pop_front(drop);
+        long_begin_  -= drop;
+        short_begin_ -= drop;
+    }
+}
+
+template <typename Policy>
+bool SweepModelT<Policy>::ewma_score(double ts, uint8_t slot, double volume,
+                                     double short_total, double& score) {
+    const double tau = Policy::long_window_sec();
+    const double short_win = Policy::short_window_sec();
+    if (!ewma_started_) {
+        ewma_started_ = true;
+        ewma_t0_ = ts;
+        ewma_ts_ = ts;
+    }
+
+    // 衰减到当前时刻；上一条 tick 的偏差视为一直保持到现在，按经过的时长计入方差
+    double dt = ts - ewma_ts_;
+    if (dt > 0.0) {
+        double decay = std::exp(-dt / tau);
+        rate_vol_[0] *= decay;
+        rate_vol_[1] *= decay;
+        rate_span_ = rate_span_ * decay + tau * (1.0 - decay);
+        if (has_dev_) {
+            dev_sq_ = dev_sq_ * decay + (1.0 - decay) * dev_ * dev_;
+            dev_weight_ = dev_weight_ * decay + (1.0 - decay);
+        }
+        ewma_ts_ = ts;
+    }
+    rate_vol_[slot] += volume;
+
+    // 预热：基线覆盖的时长不足一个短窗口
+    if (ts - ewma_t0_ < short_win || rate_span_ <= 0.0) return false;
+    double expected_short = (rate_vol_[0] + rate_vol_[1]) / rate_span_ * short_win;
+    if (expected_short <= 0.0) return false;
+
+    if (Policy::baseline() == SweepBaseline::Ewma) {
+        score = short_total / expected_short;
+        return true;
+    }
+
+    double dev = short_total - expected_short;
+    double var = dev_weight_ > 0.0 ? dev_sq_ / dev_weight_ : 0.0;
+    dev_ = dev;
+    has_dev_ = true;
+    if (var <= 0.0) return false;
+    score = dev / std::sqrt(var);
+    return true;
+}
+
+template <typename Policy>
+SweepSignal SweepModelT<Policy>::process_tick(const Tick& tick) {
+    SWEEP_LATENCY_SCOPE(ProcessTick);
+    const double short_win = Policy::short_window_sec();
+    const double long_win = Policy::long_window_sec();
+    const double threshold = Policy::threshold_ratio();
+    double ts = tick.timestamp;
+    events_.clear();
+
+    // 先驱逐过期 tick
+    evict_old(ts);
+
+    // 更新 last_price_（用上一个 tick 的 price）
+    if (!has_last_price_) {
+        last_price_ = tick.price;
+        has_last_price_ = true;
+    }
+
+    // 将当前 tick 加入窗口并更新统计量
+    uint8_t slot = slot_of(tick.side);
+    window_.push_back({ts, tick.volume, slot});
+    short_vol_[slot] += tick.volume;
+    double short_total = short_vol_[0] + short_vol_[1];
+
+    // ratio：Window / Ewma 为 短期量 / 期望量，EwmaZ 为 z-score
+    double ratio;
+    if (Policy::baseline() == SweepBaseline::Window) {
+        long_vol_[slot] += tick.volume;
+        double long_total = long_vol_[0] + long_vol_[1];
+        if (long_total <= 0.0) {
+            last_price_ = tick.price;
+            return SweepSignal::NoSignal;
+        }
+
+        // “短期量 / 长期平均量”的粗近似
+        double expected_short = (long_total / long_win) * short_win;
+        if (expected_short <= 0.0) {
+            last_price_ = tick.price;
+            return SweepSignal::NoSignal;
+        }
+        ratio = short_total / expected_short;
+    } else if (!ewma_score(ts, slot, tick.volume, short_total, ratio)) {
+        last_price_ = tick.price;
+        return SweepSignal::NoSignal;
+    }
+
+    // 当 ratio 明显回落，允许下一次 sweep
+    if (ratio < threshold * Policy::rearm_ratio()) {
+        in_sweep_ = false;
+    }
+
+    // 已处于 sweep 状态：不再重复触发
+    if (in_sweep_) {
+        last_price_ = tick.price;
+        return SweepSignal::NoSignal;
+    }
+
+    // 只在 ratio 第一次跨越阈值时触发事件
+    if (ratio >= threshold) {
+        // 进入 sweep 状态
+        in_sweep_ = true;
+        last_sweep_ts_ = ts;
+
+        // 判断方向
+        SweepSignal sig = SweepSignal::NoSignal;
+        double buy = short_vol_[0];
+        double sell = short_vol_[1];
+
+        if (buy > sell * Policy::dominance()) {
+            sig = SweepSignal::UpSweep;
+            last_event_.direction = 1;
+        } else if (sell > buy * Policy::dominance()) {
+            sig = SweepSignal::DownSweep;
+            last_event_.direction = -1;
+        } else {
+            last_event_.direction = 0;
+        }
+
+        if (sig != SweepSignal::NoSignal) {
+            // 填充事件元信息
+            last_event_.ts_end      = ts;
+            last_event_.ts_start    = ts - short_win;     // 近似窗口起点
+            last_event_.price_end   = tick.price;
+            last_event_.price_start = has_last_price_ ? last_price_ : tick.price;
+            last_event_.volume_total = short_total;
+            events_.push_back(last_event_);
+        }
+
+        last_price_ = tick.price;
+        return sig;
+    }
+
+    last_price_ = tick.price;
+    return SweepSignal::NoSignal;
+}
+
+template <typename Policy>
+std::string SweepModelT<Policy>::serialize() const {
+    StateWriter w(kStateMagic);
+    w.put(Policy::short_window_sec());
+    w.put(Policy::long_window_sec());
+    w.put(Policy::threshold_ratio());
+    w.put(Policy::dominance());
+    w.put(Policy::rearm_ratio());
+    w.put(static_cast<int32_t>(Policy::baseline()));
+
+    w.put(static_cast<uint64_t>(window_.size()));
+    for (std::size_t i = 0; i < window_.size(); ++i) {
+        w.put(window_[i].timestamp);
+        w.put(window_[i].volume);
+        w.put(window_[i].slot);
+    }
+    w.put(static_cast<uint64_t>(long_begin_));
+    w.put(static_cast<uint64_t>(short_begin_));
+    for (double v : short_vol_) w.put(v);
+    for (double v : long_vol_) w.put(v);
+    w.put(ewma_started_);
+    w.put(ewma_t0_);
+    w.put(ewma_ts_);
+    for (double v : rate_vol_) w.put(v);
+    w.put(rate_span_);
+    w.put(dev_);
+    w.put(has_dev_);
+    w.put(dev_sq_);
+    w.put(dev_weight_);
+    w.put(in_sweep_);
+    w.put(last_sweep_ts_);
+    w.put(last_price_);
+    w.put(has_last_price_);
+    put_event(w, last_event_);
+    return w.take();
+}
+
+template <typename Policy>
+void SweepModelT<Policy>::restore(const std::string& data) {
+    StateReader r(data, kStateMagic);
+    double params[5];
+    for (double& p : params) p = r.get<double>();
+    int32_t baseline = r.get<int32_t>();
+    if (params[0] != Policy::short_window_sec() || params[1] != Policy::long_window_sec() ||
+        params[2] != Policy::threshold_ratio() || params[3] != Policy::dominance() ||
+        params[4] != Policy::rearm_ratio() ||
+        baseline != static_cast<int32_t>(Policy::baseline())) {
+        throw std::invalid_argument("SweepModel snapshot was taken with different parameters");
+    }
+
+    RingBuffer<WindowTick> window;
+    std::size_t n = static_cast<std::size_t>(r.get<uint64_t>());
+    for (std::size_t i = 0; i < n; ++i) {
+        WindowTick t;
+        t.timestamp = r.get<double>();
+        t.volume = r.get<double>();
+        t.slot = r.get<uint8_t>();
+        if (t.slot > 1) throw std::runtime_error("state: corrupt sweep window");
+        window.push_back(t);
+    }
+    std::size_t long_begin = static_cast<std::size_t>(r.get<uint64_t>());
+    std::size_t short_begin = static_cast<std::size_t>(r.get<uint64_t>());
+    if (long_begin > n || short_begin > n) {
+        throw std::runtime_error("state: corrupt sweep window");
+    }
+    double short_vol[2], long_vol[2];
+    for (double& v : short_vol) v = r.get<double>();
+    for (double& v : long_vol) v = r.get<double>();
+    bool ewma_started = r.get<bool>();
+    double ewma_t0 = r.get<double>();
+    double ewma_ts = r.get<double>();
+    double rate_vol[2];
+    for (double& v : rate_vol) v = r.get<double>();
+    double rate_span = r.get<double>();
+    double dev = r.get<double>();
+    bool has_dev = r.get<bool>();
+    double dev_sq = r.get<double>();
+    double dev_weight = r.get<double>();
+    bool in_sweep = r.get<bool>();
+    double last_sweep_ts = r.get<double>();
+    double last_price = r.get<double>();
+    bool has_last_price = r.get<bool>();
+    SweepEventMeta last_event = get_event(r);
+    r.finish();
+
+    // 全部读成功才覆盖，失败时对象保持原状
+    window_ = std::move(window);
+    long_begin_ = long_begin;
+    short_begin_ = short_begin;
+    for (int k = 0; k < 2; ++k) {
+        short_vol_[k] = short_vol[k];
+        long_vol_[k] = long_vol[k];
+        rate_vol_[k] = rate_vol[k];
+    }
+    ewma_started_ = ewma_started;
+    ewma_t0_ = ewma_t0;
+    ewma_ts_ = ewma_ts;
+    rate_span_ = rate_span;
+    dev_ = dev;
+    has_dev_ = has_dev;
+    dev_sq_ = dev_sq;
+    dev_weight_ = dev_weight;
+    in_sweep_ = in_sweep;
+    last_sweep_ts_ = last_sweep_ts;
+    last_price_ = last_price;
+    has_last_price_ = has_last_price;
+    last_event_ = last_event;
+    events_.clear();
+}
+
+// 运行期实例在 sweep_model.cpp 里实例化一次
+extern template class SweepModelT<RuntimeSweepPolicy>;
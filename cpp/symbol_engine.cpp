@@ -0,0 +1,197 @@
+// cpp/symbol_engine.cpp
+#include "symbol_engine.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "json_scan.h"
+
+namespace {
+
+// 连续空轮询这么多次后让出 CPU（绑核时仍基本是忙等）
+constexpr int kSpinBeforeYield = 256;
+
+// topic 的最后一段即 symbol：publicTrade.<symbol> / orderbook.<depth>.<symbol>
+// 找到 topic 就停止扫描，不解析 data
+bool topic_symbol(const char* data, std::size_t len, std::string_view& symbol) {
+    JsonScanner js(data, len);
+    std::string_view topic;
+    bool found = false;
+    js.for_each_member([&](std::string_view key) {
+        if (key == "topic") {
+            found = js.read_string(topic);
+            return false;
+        }
+        return js.skip_value();
+    });
+    if (!found) return false;
+    std::size_t dot = topic.rfind('.');
+    if (dot == std::string_view::npos || dot + 1 >= topic.size()) return false;
+    symbol = topic.substr(dot + 1);
+    return true;
+}
+
+void pin_to_cpu(std::thread& t, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // 绑核失败（cpu 不存在 / 受 cgroup 限制）时照常运行，不影响正确性
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+}
+
+}  // namespace
+
+SymbolEngine::SymbolEngine(unsigned num_workers, std::vector<int> cpus,
+                           std::size_t queue_capacity, std::size_t output_capacity)
+    : requested_workers_(num_workers),
+      cpus_(std::move(cpus)),
+      queue_capacity_(queue_capacity),
+      output_(output_capacity) {}
+
+SymbolEngine::~SymbolEngine() { stop(); }
+
+uint32_t SymbolEngine::add_symbol(const std::string& symbol,
+                                  const SweepModel& model,
+                                  const MeanReversionStrategy& strategy,
+                                  const OrderFlowFeatureExtractor& extractor) {
+    if (started_) throw std::logic_error("SymbolEngine: add_symbol after start()");
+    if (by_name_.count(symbol)) throw std::logic_error("SymbolEngine: duplicate symbol " + symbol);
+    uint32_t id = static_cast<uint32_t>(feeds_.size());
+    feeds_.push_back(std::make_unique<BybitFeedHandler>(symbol, model, strategy, extractor));
+    by_name_.emplace(symbol, id);
+    return id;
+}
+
+void SymbolEngine::set_journal(EventJournal* journal) {
+    if (started_) throw std::logic_error("SymbolEngine: set_journal after start()");
+    journal_ = journal;
+}
+
+void SymbolEngine::start() {
+    if (started_) throw std::logic_error("SymbolEngine: already started");
+    if (feeds_.empty()) throw std::logic_error("SymbolEngine: no symbols registered");
+    started_ = true;
+
+    for (std::size_t id = 0; id < feeds_.size(); ++id) {
+        feeds_[id]->set_journal(journal_, static_cast<uint32_t>(id));
+    }
+
+    unsigned n = requested_workers_;
+    if (n == 0) n = std::max(1u, std::thread::hardware_concurrency());
+    n = static_cast<unsigned>(std::min<std::size_t>(n, feeds_.size()));
+
+    owner_.resize(feeds_.size());
+    for (std::size_t id = 0; id < feeds_.size(); ++id) {
+        owner_[id] = static_cast<unsigned>(id % n);
+    }
+
+    workers_.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+        workers_.push_back(std::make_unique<Worker>(queue_capacity_));
+        if (!cpus_.empty()) workers_.back()->cpu = cpus_[i % cpus_.size()];
+    }
+
+    running_.store(true, std::memory_order_release);
+    for (auto& w : workers_) {
+        w->thread = std::thread(&SymbolEngine::run_worker, this, std::ref(*w));
+        if (w->cpu >= 0) pin_to_cpu(w->thread, w->cpu);
+    }
+}
+
+void SymbolEngine::stop() {
+    // 与 post() 的 posting_ / running_ 成对（都是 seq_cst）：post 要么看到 running_ 已清，
+    // 要么 stop 在这里等它写完，worker 再排空队列退出
+    running_.store(false, std::memory_order_seq_cst);
+    while (posting_.load(std::memory_order_seq_cst)) std::this_thread::yield();
+    stop_workers_.store(true, std::memory_order_release);
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+bool SymbolEngine::post(const char* data, std::size_t len) {
+    std::string_view sym;
+    if (!topic_symbol(data, len, sym)) {
+        unrouted_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // symbol 名一般在 SSO 长度内，构造 key 不分配
+    auto it = by_name_.find(std::string(sym));
+    if (it == by_name_.end()) {
+        unrouted_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    posting_.store(true, std::memory_order_seq_cst);
+    if (!running_.load(std::memory_order_seq_cst)) {
+        posting_.store(false, std::memory_order_release);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Worker& w = *workers_[owner_[it->second]];
+    Message* slot = w.input.try_reserve();
+    if (!slot) {
+        posting_.store(false, std::memory_order_release);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slot->symbol = it->second;
+    slot->data.assign(data, len);  // 槽位复用，预热后不再分配
+    w.input.commit();
+    posting_.store(false, std::memory_order_release);
+    posted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SymbolEngine::run_worker(Worker& w) {
+    int idle = 0;
+    for (;;) {
+        Message* msg = w.input.front();
+        if (!msg) {
+            // 先确认队列空再看停止标志：stop() 之前投递的消息都会处理完
+            if (stop_workers_.load(std::memory_order_acquire) && w.input.empty()) return;
+            if (++idle >= kSpinBeforeYield) {
+                idle = 0;
+                std::this_thread::yield();
+            }
+            continue;
+        }
+        idle = 0;
+
+        BybitFeedHandler& feed = *feeds_[msg->symbol];
+        std::size_t n = 0;
+        try {
+            n = feed.on_message(msg->data.data(), msg->data.size());
+        } catch (...) {
+            // 异常逃出 std::thread 会 terminate 整个进程：记数后跳过这条消息
+            errors_.fetch_add(1, std::memory_order_relaxed);
+            n = 0;
+        }
+        if (n > 0) {
+            for (const StrategyAction& act : feed.actions()) {
+                if (output_.try_push({msg->symbol, act})) {
+                    actions_.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    dropped_actions_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        w.input.pop();
+    }
+}
+
+EngineStats SymbolEngine::stats() const {
+    EngineStats s;
+    s.posted = posted_.load(std::memory_order_relaxed);
+    s.rejected = rejected_.load(std::memory_order_relaxed);
+    s.unrouted = unrouted_.load(std::memory_order_relaxed);
+    s.actions = actions_.load(std::memory_order_relaxed);
+    s.dropped_actions = dropped_actions_.load(std::memory_order_relaxed);
+    s.errors = errors_.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,126 @@
+// cpp/symbol_engine.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bybit_feed.h"
+#include "mpsc_queue.h"
+#include "spsc_queue.h"
+
+// 引擎输出：哪个 symbol 的哪个动作（symbol 为 add_symbol 返回的编号）
+struct EngineAction {
+    uint32_t       symbol;
+    StrategyAction action;
+};
+
+struct EngineStats {
+    int64_t posted = 0;           // 成功入队的消息
+    int64_t rejected = 0;         // worker 输入队列满，被丢弃
+    int64_t unrouted = 0;         // 没有 topic / symbol 未注册（订阅回执、心跳等）
+    int64_t actions = 0;          // 写入输出队列的动作
+    int64_t dropped_actions = 0;  // 输出队列满，被丢弃
+    int64_t errors = 0;           // 处理时抛异常的消息（跳过，worker 继续）
+};
+
+// === 多 symbol 分片引擎 ===
+// 每个 symbol 一个 BybitFeedHandler（模型 / 策略 / 特征），按注册顺序轮流分给各 worker；
+// 一个 symbol 永远只在它所属的 worker 线程上处理，状态不需要加锁
+// 线程模型：
+//   post()：唯一的接收线程调用；按 topic 里的 symbol 把原始消息拷进所属 worker 的 SPSC 队列
+//   worker：可绑核（cpus），忙轮询自己的队列，产生的非 Idle 动作写入共享的 MPSC 输出队列；
+//           单条消息处理抛异常时计入 errors 并跳过，不会带走进程
+//   poll()：唯一的消费线程调用（Python 只做下单路由）
+// add_symbol 只能在 start() 之前调用；start() 只能调用一次，之后才确定 symbol -> worker
+class SymbolEngine {
+public:
+    // num_workers=0 时用 hardware_concurrency（不超过 symbol 数）；
+    // cpus 非空时 worker i 绑到 cpus[i % cpus.size()]
+    explicit SymbolEngine(unsigned num_workers = 0,
+                          std::vector<int> cpus = {},
+                          std::size_t queue_capacity = 4096,
+                          std::size_t output_capacity = 65536);
+    ~SymbolEngine();
+
+    SymbolEngine(const SymbolEngine&) = delete;
+    SymbolEngine& operator=(const SymbolEngine&) = delete;
+
+    // 注册 symbol，返回编号；重复注册或已 start 时抛 std::logic_error
+    uint32_t add_symbol(const std::string& symbol,
+                        const SweepModel& model = SweepModel(),
+                        const MeanReversionStrategy& strategy = MeanReversionStrategy(),
+                        const OrderFlowFeatureExtractor& extractor = OrderFlowFeatureExtractor());
+
+    // 所有 symbol 的 sweep / 动作写进同一个日志（记录里的 symbol 为编号），须在 start() 之前设置
+    // journal 由调用方持有，须比引擎活得久
+    void set_journal(EventJournal* journal);
+
+    // 已 start 或没有注册 symbol 时抛 std::logic_error
+    void start();
+    // 各 worker 处理完队列里剩余的消息后退出；可重复调用
+    // 与 post() 并发时：post 要么被拒（返回 false），要么它投递的消息在 worker 退出前处理完
+    void stop();
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // 投递一条 WebSocket 原始消息；未路由或队列满返回 false
+    bool post(const char* data, std::size_t len);
+
+    // 取一个动作；没有时返回 false
+    bool poll(EngineAction& out) { return output_.try_pop(out); }
+
+    std::size_t num_symbols() const { return feeds_.size(); }
+    std::size_t num_workers() const { return workers_.size(); }
+    const std::string& symbol(uint32_t id) const { return feeds_[id]->symbol(); }
+    unsigned worker_of(uint32_t id) const { return owner_[id]; }
+
+    // 只在 stop() 之后读才是一致的（运行中归 worker 线程所有）
+    const BybitFeedHandler& feed(uint32_t id) const { return *feeds_[id]; }
+
+    EngineStats stats() const;
+    std::size_t queue_depth(unsigned worker) const { return workers_[worker]->input.size(); }
+    std::size_t output_depth() const { return output_.size(); }
+
+private:
+    struct Message {
+        uint32_t    symbol = 0;
+        std::string data;
+    };
+
+    struct Worker {
+        explicit Worker(std::size_t capacity) : input(capacity) {}
+        SpscQueue<Message> input;
+        std::thread thread;
+        int cpu = -1;
+    };
+
+    unsigned requested_workers_;
+    std::vector<int> cpus_;
+    std::size_t queue_capacity_;
+
+    std::vector<std::unique_ptr<BybitFeedHandler>> feeds_;
+    std::vector<unsigned> owner_;                          // symbol -> worker
+    std::unordered_map<std::string, uint32_t> by_name_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    EventJournal* journal_ = nullptr;
+    MpscQueue<EngineAction> output_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> posting_{false};       // post() 正在往 worker 队列里写
+    std::atomic<bool> stop_workers_{false};  // 没有进行中的 post 之后才置位，worker 排空队列后退出
+    bool started_ = false;
+
+    // 生产端（post）只有一个线程写，worker 各自 fetch_add
+    std::atomic<int64_t> posted_{0};
+    std::atomic<int64_t> rejected_{0};
+    std::atomic<int64_t> unrouted_{0};
+    std::atomic<int64_t> actions_{0};
+    std::atomic<int64_t> dropped_actions_{0};
+    std::atomic<int64_t> errors_{0};
+
+    void run_worker(Worker& w);
+};
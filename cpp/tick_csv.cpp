@@ -0,0 +1,165 @@
+// cpp/tick_csv.cpp
+#include "tick_csv.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "fast_parse.h"
+
+namespace {
+
+const char* find_newline(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    return nl ? nl : end;
+}
+
+// p 之后的下一个行首（p 本身在行首时不动）
+const char* align_to_line(const char* begin, const char* p, const char* end) {
+    if (p <= begin || p >= end) return p < end ? p : end;
+    if (p[-1] == '\n') return p;
+    const char* nl = find_newline(p, end);
+    return nl < end ? nl + 1 : end;
+}
+
+}  // namespace
+
+bool parse_tick_row(const char* first, const char* last,
+                    double& ts, double& price, double& volume, int8_t& side) {
+    const char* f[4];
+    const char* fe[4];
+    const char* q = first;
+    int k = 0;
+    for (; k < 4 && q <= last; ++k) {
+        const char* c = static_cast<const char*>(std::memchr(q, ',', static_cast<std::size_t>(last - q)));
+        f[k] = q;
+        fe[k] = c ? c : last;
+        q = fe[k] + 1;
+    }
+    return k == 4 &&
+           parse_double(f[0], fe[0], ts) &&
+           parse_double(f[1], fe[1], price) &&
+           parse_double(f[2], fe[2], volume) &&
+           parse_side(f[3], fe[3], side);
+}
+
+TickCsvReader::TickCsvReader(const std::string& path, std::size_t batch_bytes, unsigned num_threads)
+    : path_(path),
+      file_(path),
+      batch_bytes_(batch_bytes > 0 ? batch_bytes : (64u << 20)),
+      num_threads_(num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency())) {
+    const char* data = file_.data();
+    end_ = data + file_.size();
+    body_ = data;
+    if (data) {
+        file_.advise_sequential();
+        // 首行解析不了就当表头
+        const char* le = find_newline(data, end_);
+        const char* stop = (le > data && le[-1] == '\r') ? le - 1 : le;
+        double a, b, c;
+        int8_t s;
+        if (!parse_tick_row(data, stop, a, b, c, s)) body_ = le < end_ ? le + 1 : end_;
+    }
+    pos_ = body_;
+    parts_.resize(num_threads_);
+}
+
+std::size_t TickCsvReader::count_rows() const {
+    std::size_t rows = 0;
+    for (const char* p = body_; p < end_;) {
+        const char* le = find_newline(p, end_);
+        if (le > p && !(le - p == 1 && *p == '\r')) ++rows;
+        p = le + 1;
+    }
+    return rows;
+}
+
+void TickCsvReader::parse_segment(const char* first, const char* last, TickBatch& out) const {
+    out.clear();
+    // 按平均行长（~32 字节）预估
+    std::size_t est = static_cast<std::size_t>(last - first) / 32 + 16;
+    out.ts.reserve(est);
+    out.price.reserve(est);
+    out.volume.reserve(est);
+    out.side.reserve(est);
+
+    for (const char* p = first; p < last;) {
+        const char* le = find_newline(p, last);
+        const char* next = le + 1;
+        if (le > p && le[-1] == '\r') --le;
+        if (le > p) {
+            double ts, price, volume;
+            int8_t side;
+            if (!parse_tick_row(p, le, ts, price, volume, side)) {
+                throw std::runtime_error("bad CSV row at byte " +
+                                         std::to_string(p - file_.data()) + ": " + path_);
+            }
+            out.ts.push_back(ts);
+            out.price.push_back(price);
+            out.volume.push_back(volume);
+            out.side.push_back(side);
+        }
+        p = next;
+    }
+}
+
+bool TickCsvReader::next(TickBatch& out) {
+    out.clear();
+    if (pos_ >= end_) return false;
+
+    const char* start = pos_;
+    const char* stop = align_to_line(start, start + std::min<std::size_t>(batch_bytes_, end_ - start), end_);
+
+    // 块内按换行边界切成 num_threads_ 段并行解析
+    std::size_t len = static_cast<std::size_t>(stop - start);
+    unsigned segs = static_cast<unsigned>(std::min<std::size_t>(num_threads_, len / 4096 + 1));
+    std::vector<const char*> cuts(segs + 1);
+    cuts[0] = start;
+    for (unsigned k = 1; k < segs; ++k) {
+        cuts[k] = std::max(cuts[k - 1], align_to_line(start, start + len * k / segs, stop));
+    }
+    cuts[segs] = stop;
+
+    if (segs == 1) {
+        parse_segment(start, stop, parts_[0]);
+    } else {
+        std::vector<std::thread> pool;
+        std::vector<std::exception_ptr> errors(segs);
+        pool.reserve(segs);
+        for (unsigned k = 0; k < segs; ++k) {
+            pool.emplace_back([&, k]() {
+                try {
+                    parse_segment(cuts[k], cuts[k + 1], parts_[k]);
+                } catch (...) {
+                    errors[k] = std::current_exception();
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        for (auto& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    }
+
+    // 按文件顺序拼接
+    std::size_t total = 0;
+    for (unsigned k = 0; k < segs; ++k) total += parts_[k].size();
+    out.ts.reserve(total);
+    out.price.reserve(total);
+    out.volume.reserve(total);
+    out.side.reserve(total);
+    for (unsigned k = 0; k < segs; ++k) {
+        const TickBatch& p = parts_[k];
+        out.ts.insert(out.ts.end(), p.ts.begin(), p.ts.end());
+        out.price.insert(out.price.end(), p.price.begin(), p.price.end());
+        out.volume.insert(out.volume.end(), p.volume.begin(), p.volume.end());
+        out.side.insert(out.side.end(), p.side.begin(), p.side.end());
+    }
+
+    file_.release(start, stop);
+    pos_ = stop;
+    rows_read_ += total;
+    return true;
+}
@@ -0,0 +1,63 @@
+// cpp/tick_csv.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+// 一批列式 tick（side: +1=Buy, -1=Sell）
+struct TickBatch {
+    std::vector<double> ts;
+    std::vector<double> price;
+    std::vector<double> volume;
+    std::vector<int8_t> side;
+
+    std::size_t size() const { return ts.size(); }
+    void clear() {
+        ts.clear();
+        price.clear();
+        volume.clear();
+        side.clear();
+    }
+};
+
+// 解析一行 ts,price,volume,side（不含换行；side 接受 B/Buy/S/Sell）
+bool parse_tick_row(const char* first, const char* last,
+                    double& ts, double& price, double& volume, int8_t& side);
+
+// === 流式 CSV 读取：文件 mmap 后按 batch_bytes 切块，每块按换行边界再分给多个线程并行解析 ===
+// 每次 next() 只保留一块的解析结果，峰值内存与文件大小无关
+// 格式为 fetch_trades_eth.py 的 ts,price,volume,side；首行若不是数据则当表头跳过
+// 解析失败抛 std::runtime_error（带字节偏移）
+class TickCsvReader {
+public:
+    explicit TickCsvReader(const std::string& path,
+                           std::size_t batch_bytes = 64u << 20,
+                           unsigned num_threads = 0);
+
+    // 读下一批（按文件顺序）；读完返回 false
+    bool next(TickBatch& out);
+
+    std::size_t rows_read() const { return rows_read_; }
+    std::size_t bytes_total() const { return file_.size(); }
+    std::size_t bytes_read() const { return static_cast<std::size_t>(pos_ - file_.data()); }
+
+    // 数据行数（不解析，只数非空行）
+    std::size_t count_rows() const;
+
+private:
+    std::string path_;
+    MappedFile file_;
+    const char* end_ = nullptr;
+    const char* body_ = nullptr;  // 表头之后
+    const char* pos_ = nullptr;
+    std::size_t batch_bytes_;
+    unsigned num_threads_;
+    std::size_t rows_read_ = 0;
+
+    std::vector<TickBatch> parts_;  // 每个线程一段，复用
+
+    void parse_segment(const char* first, const char* last, TickBatch& out) const;
+};
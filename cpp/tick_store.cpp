@@ -0,0 +1,150 @@
+// cpp/tick_store.cpp
+#include "tick_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "tick_csv.h"
+
+namespace {
+
+constexpr uint64_t kAlign = 64;
+
+uint64_t align_up(uint64_t v) { return (v + kAlign - 1) / kAlign * kAlign; }
+
+[[noreturn]] void fail(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + ": " + path + " (" + std::strerror(errno) + ")");
+}
+
+}  // namespace
+
+// ---------------- TickStoreWriter ----------------
+
+TickStoreWriter::TickStoreWriter(const std::string& path, uint64_t n_ticks, uint64_t chunk_rows)
+    : n_ticks_(n_ticks) {
+    if (chunk_rows == 0) chunk_rows = kDefaultChunkRows;
+    uint64_t n_chunks = (n_ticks + chunk_rows - 1) / chunk_rows;
+
+    TickStoreHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kTickStoreMagic, sizeof(h.magic));
+    h.version = kTickStoreVersion;
+    h.header_bytes = sizeof(TickStoreHeader);
+    h.n_ticks = n_ticks;
+    h.chunk_rows = chunk_rows;
+    h.n_chunks = n_chunks;
+    h.ts_offset = align_up(sizeof(TickStoreHeader));
+    h.price_offset = align_up(h.ts_offset + n_ticks * sizeof(double));
+    h.volume_offset = align_up(h.price_offset + n_ticks * sizeof(double));
+    h.side_offset = align_up(h.volume_offset + n_ticks * sizeof(double));
+    h.index_offset = align_up(h.side_offset + n_ticks * sizeof(int8_t));
+    h.file_bytes = h.index_offset + n_chunks * sizeof(TickChunk);
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) fail("cannot create", path);
+    bytes_ = static_cast<std::size_t>(h.file_bytes);
+    if (::ftruncate(fd_, static_cast<off_t>(bytes_)) != 0) {
+        ::close(fd_);
+        fail("cannot resize", path);
+    }
+    void* p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd_);
+        fail("cannot mmap", path);
+    }
+    base_ = static_cast<char*>(p);
+    std::memcpy(base_, &h, sizeof(h));
+}
+
+TickStoreWriter::~TickStoreWriter() {
+    // 没有 finish() 就析构（写入中途出错）：清掉 magic，读端会拒绝这个不完整的文件
+    if (!finished_) std::memset(header().magic, 0, sizeof(header().magic));
+    ::munmap(base_, bytes_);
+    ::close(fd_);
+}
+
+void TickStoreWriter::write(uint64_t row, const double* ts, const double* price,
+                            const double* volume, const int8_t* side, std::size_t n) {
+    if (row + n > n_ticks_) {
+        throw std::out_of_range("TickStoreWriter::write past end of store");
+    }
+    const TickStoreHeader& h = header();
+    std::memcpy(base_ + h.ts_offset + row * sizeof(double), ts, n * sizeof(double));
+    std::memcpy(base_ + h.price_offset + row * sizeof(double), price, n * sizeof(double));
+    std::memcpy(base_ + h.volume_offset + row * sizeof(double), volume, n * sizeof(double));
+    std::memcpy(base_ + h.side_offset + row, side, n * sizeof(int8_t));
+}
+
+void TickStoreWriter::finish() {
+    if (finished_) return;
+    finished_ = true;
+    const TickStoreHeader& h = header();
+    const double* ts = reinterpret_cast<const double*>(base_ + h.ts_offset);
+    TickChunk* index = reinterpret_cast<TickChunk*>(base_ + h.index_offset);
+    for (uint64_t c = 0; c < h.n_chunks; ++c) {
+        uint64_t first = c * h.chunk_rows;
+        uint64_t rows = std::min(h.chunk_rows, h.n_ticks - first);
+        index[c] = {first, rows, ts[first], ts[first + rows - 1]};
+    }
+    ::msync(base_, bytes_, MS_SYNC);
+}
+
+// ---------------- TickStore ----------------
+
+TickStore::TickStore(const std::string& path) : file_(path), base_(file_.data()) {
+    if (file_.size() < sizeof(TickStoreHeader)) {
+        throw std::runtime_error("not a tick store (too small): " + path);
+    }
+    header_ = reinterpret_cast<const TickStoreHeader*>(base_);
+    if (std::memcmp(header_->magic, kTickStoreMagic, sizeof(kTickStoreMagic)) != 0 ||
+        header_->version != kTickStoreVersion ||
+        header_->file_bytes != file_.size()) {
+        throw std::runtime_error("not a tick store (bad header): " + path);
+    }
+}
+
+std::size_t TickStore::lower_bound(double t) const {
+    const TickChunk* idx = chunks();
+    const TickChunk* end = idx + num_chunks();
+    // 第一个 ts_last >= t 的块
+    const TickChunk* c = std::lower_bound(idx, end, t, [](const TickChunk& ch, double v) {
+        return ch.ts_last < v;
+    });
+    if (c == end) return size();
+    const double* first = ts() + c->first_row;
+    const double* it = std::lower_bound(first, first + c->rows, t);
+    return static_cast<std::size_t>(it - ts());
+}
+
+// ---------------- helpers ----------------
+
+void write_tick_store(const std::string& path, const double* ts, const double* price,
+                      const double* volume, const int8_t* side, std::size_t n,
+                      uint64_t chunk_rows) {
+    TickStoreWriter w(path, n, chunk_rows);
+    w.write(0, ts, price, volume, side, n);
+    w.finish();
+}
+
+std::size_t convert_csv_to_tick_store(const std::string& csv_path, const std::string& store_path,
+                                      uint64_t chunk_rows, unsigned num_threads) {
+    TickCsvReader reader(csv_path, 64u << 20, num_threads);
+    // 先数行确定文件大小，再逐批解析写入
+    std::size_t rows = reader.count_rows();
+    TickStoreWriter w(store_path, rows, chunk_rows);
+    TickBatch batch;
+    std::size_t written = 0;
+    while (reader.next(batch)) {
+        w.write(written, batch.ts.data(), batch.price.data(), batch.volume.data(),
+                batch.side.data(), batch.size());
+        written += batch.size();
+    }
+    w.finish();
+    return written;
+}
@@ -0,0 +1,115 @@
+// cpp/tick_store.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mapped_file.h"
+
+// === 列式二进制 tick 文件（mmap 读取，回放零拷贝）===
+// 布局：
+//   [TickStoreHeader]
+//   ts     float64[n]   （各列按 64 字节对齐）
+//   price  float64[n]
+//   volume float64[n]
+//   side   int8[n]      （+1=Buy, -1=Sell）
+//   chunk index: TickChunk[n_chunks]，每 chunk_rows 行一项，用于按时间定位
+// 字节序为本机字节序（x86_64 小端）
+
+constexpr char kTickStoreMagic[8] = {'S', 'W', 'T', 'I', 'C', 'K', '0', '1'};
+constexpr uint32_t kTickStoreVersion = 1;
+constexpr uint64_t kDefaultChunkRows = 65536;
+
+struct TickStoreHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    uint64_t n_ticks;
+    uint64_t chunk_rows;
+    uint64_t n_chunks;
+    uint64_t ts_offset;
+    uint64_t price_offset;
+    uint64_t volume_offset;
+    uint64_t side_offset;
+    uint64_t index_offset;
+    uint64_t file_bytes;
+};
+
+struct TickChunk {
+    uint64_t first_row;
+    uint64_t rows;
+    double   ts_first;
+    double   ts_last;
+};
+
+// 写入：行数事先确定，文件一次性 ftruncate 后 mmap 写入；写完 finish() 生成 chunk 索引
+// 出错抛 std::runtime_error
+class TickStoreWriter {
+public:
+    TickStoreWriter(const std::string& path, uint64_t n_ticks,
+                    uint64_t chunk_rows = kDefaultChunkRows);
+    ~TickStoreWriter();
+
+    TickStoreWriter(const TickStoreWriter&) = delete;
+    TickStoreWriter& operator=(const TickStoreWriter&) = delete;
+
+    // 写入 [row, row+n) 行；不同区间可由不同线程并发写
+    void write(uint64_t row, const double* ts, const double* price,
+               const double* volume, const int8_t* side, std::size_t n);
+
+    // 生成 chunk 索引并落盘；未调用就析构的文件会被标记为无效
+    void finish();
+
+    uint64_t size() const { return n_ticks_; }
+
+private:
+    int fd_ = -1;
+    char* base_ = nullptr;
+    std::size_t bytes_ = 0;
+    uint64_t n_ticks_ = 0;
+    bool finished_ = false;
+
+    TickStoreHeader& header() { return *reinterpret_cast<TickStoreHeader*>(base_); }
+};
+
+// 只读 mmap 视图；列指针在对象存活期间有效
+class TickStore {
+public:
+    explicit TickStore(const std::string& path);
+
+    TickStore(const TickStore&) = delete;
+    TickStore& operator=(const TickStore&) = delete;
+
+    std::size_t size() const { return static_cast<std::size_t>(header_->n_ticks); }
+    const double* ts() const { return column<double>(header_->ts_offset); }
+    const double* price() const { return column<double>(header_->price_offset); }
+    const double* volume() const { return column<double>(header_->volume_offset); }
+    const int8_t* side() const { return column<int8_t>(header_->side_offset); }
+
+    std::size_t num_chunks() const { return static_cast<std::size_t>(header_->n_chunks); }
+    const TickChunk* chunks() const { return column<TickChunk>(header_->index_offset); }
+
+    // 第一条 ts >= t 的行号（先查 chunk 索引再在块内二分）；全部小于 t 时返回 size()
+    std::size_t lower_bound(double t) const;
+
+private:
+    MappedFile file_;
+    const char* base_ = nullptr;
+    const TickStoreHeader* header_ = nullptr;
+
+    template <typename T>
+    const T* column(uint64_t offset) const {
+        return reinterpret_cast<const T*>(base_ + offset);
+    }
+};
+
+// 列数组 -> 二进制文件
+void write_tick_store(const std::string& path, const double* ts, const double* price,
+                      const double* volume, const int8_t* side, std::size_t n,
+                      uint64_t chunk_rows = kDefaultChunkRows);
+
+// ts,price,volume,side 格式的 CSV（fetch_trades_eth.py 产出）-> 二进制文件，返回行数
+// 经 TickCsvReader 流式并行解析，内存占用与文件大小无关
+std::size_t convert_csv_to_tick_store(const std::string& csv_path, const std::string& store_path,
+                                      uint64_t chunk_rows = kDefaultChunkRows,
+                                      unsigned num_threads = 0);
@@ -0,0 +1,48 @@
+// cpp/trade_book_merge.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "market_queue.h"  // kRecordSnapshot
+
+// === 成交 + 盘口两路列式流按时间归并（ReplayEngine / 带盘口的 Backtester / ParamGrid 共用）===
+// 输入约定同 ReplayEngine::run：
+//   成交 trade_ts 升序；盘口每行一档 ts / price / size / side（>0=Bid）/ flags（可为 nullptr）
+//   ts 相同的连续行为一条消息；flags 含 kRecordSnapshot 的行开始一条 snapshot 消息
+// 同一时间戳先成交、后盘口
+// on_trade(i)：第 i 笔成交
+// on_book(ts, snapshot, rows)：一条盘口消息，档位已按 N×2 (price, size) 写入 bids / asks
+// 排序由调用方检查
+template <typename OnTrade, typename OnBook>
+void merge_trade_book(const double* trade_ts, std::size_t n_trades,
+                      const double* book_ts, const double* book_price, const double* book_size,
+                      const int8_t* book_side, const uint8_t* book_flags, std::size_t n_book,
+                      std::vector<double>& bids, std::vector<double>& asks,
+                      OnTrade&& on_trade, OnBook&& on_book) {
+    std::size_t i = 0, j = 0;
+    while (i < n_trades || j < n_book) {
+        bool take_trade = j == n_book || (i < n_trades && trade_ts[i] <= book_ts[j]);
+        if (take_trade) {
+            on_trade(i);
+            ++i;
+            continue;
+        }
+
+        // 一条盘口消息：ts 相同的连续行，遇到下一条 snapshot 起始行截断
+        double ts = book_ts[j];
+        bool snapshot = book_flags && (book_flags[j] & kRecordSnapshot);
+        bids.clear();
+        asks.clear();
+        std::size_t k = j;
+        do {
+            std::vector<double>& side = book_side[k] > 0 ? bids : asks;
+            side.push_back(book_price[k]);
+            side.push_back(book_size[k]);
+            ++k;
+        } while (k < n_book && book_ts[k] == ts &&
+                 !(book_flags && (book_flags[k] & kRecordSnapshot)));
+        on_book(ts, snapshot, k - j);
+        j = k;
+    }
+}
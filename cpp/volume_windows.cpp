@@ -0,0 +1,287 @@
+// cpp/volume_windows.cpp
+#include "volume_windows.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SWEEP_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// [0, n) 内按 side 分开求和：side > 0 记为 buy，其余为 sell
+using SegmentSum = void (*)(const double* volume, const int8_t* side, std::size_t n,
+                            double* buy, double* sell);
+
+void segment_sum_scalar(const double* volume, const int8_t* side, std::size_t n,
+                        double* buy, double* sell) {
+    double b = 0.0, s = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (side[i] > 0) b += volume[i];
+        else s += volume[i];
+    }
+    *buy = b;
+    *sell = s;
+}
+
+#ifdef SWEEP_X86_DISPATCH
+
+// 4 个 side 字节 -> 4 × 64 位掩码（side > 0 为全 1）
+__attribute__((target("avx2"))) inline __m256d buy_mask4(const int8_t* side) {
+    int32_t raw;
+    std::memcpy(&raw, side, sizeof(raw));
+    __m256i s = _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(raw));
+    return _mm256_castsi256_pd(_mm256_cmpgt_epi64(s, _mm256_setzero_si256()));
+}
+
+__attribute__((target("avx2"))) inline double hsum4(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+// 每次 8 笔，两组累加器错开加法延迟
+__attribute__((target("avx2")))
+void segment_sum_avx2(const double* volume, const int8_t* side, std::size_t n,
+                      double* buy, double* sell) {
+    __m256d b0 = _mm256_setzero_pd(), b1 = _mm256_setzero_pd();
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d m0 = buy_mask4(side + i);
+        __m256d m1 = buy_mask4(side + i + 4);
+        __m256d v0 = _mm256_loadu_pd(volume + i);
+        __m256d v1 = _mm256_loadu_pd(volume + i + 4);
+        b0 = _mm256_add_pd(b0, _mm256_and_pd(m0, v0));
+        s0 = _mm256_add_pd(s0, _mm256_andnot_pd(m0, v0));
+        b1 = _mm256_add_pd(b1, _mm256_and_pd(m1, v1));
+        s1 = _mm256_add_pd(s1, _mm256_andnot_pd(m1, v1));
+    }
+    if (i + 4 <= n) {
+        __m256d m0 = buy_mask4(side + i);
+        __m256d v0 = _mm256_loadu_pd(volume + i);
+        b0 = _mm256_add_pd(b0, _mm256_and_pd(m0, v0));
+        s0 = _mm256_add_pd(s0, _mm256_andnot_pd(m0, v0));
+        i += 4;
+    }
+    double b = hsum4(_mm256_add_pd(b0, b1));
+    double s = hsum4(_mm256_add_pd(s0, s1));
+    for (; i < n; ++i) {
+        if (side[i] > 0) b += volume[i];
+        else s += volume[i];
+    }
+    *buy = b;
+    *sell = s;
+}
+
+// 8 个 side 字节 -> 8 × int64；用 maskz 版本（其余形式以未初始化寄存器作底，GCC -Wall 会告警）
+__attribute__((target("avx512f"))) inline __m512i load_side8(const int8_t* side) {
+    __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(side));
+    return _mm512_maskz_cvtepi8_epi64(static_cast<__mmask8>(0xFF), raw);
+}
+
+// 同上，不用 _mm512_reduce_add_pd / castpd512_pd256：两半都用 maskz 抽取
+__attribute__((target("avx512f"))) inline double hsum8(__m512d v) {
+    __m256d lo = _mm512_maskz_extractf64x4_pd(static_cast<__mmask8>(0xFF), v, 0);
+    __m256d hi = _mm512_maskz_extractf64x4_pd(static_cast<__mmask8>(0xFF), v, 1);
+    return hsum4(_mm256_add_pd(lo, hi));
+}
+
+// 每次 16 笔；side 直接比较成 8 位掩码，按掩码加到 buy / sell
+__attribute__((target("avx512f")))
+void segment_sum_avx512(const double* volume, const int8_t* side, std::size_t n,
+                        double* buy, double* sell) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512d b0 = _mm512_setzero_pd(), b1 = _mm512_setzero_pd();
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i sd0 = load_side8(side + i);
+        __m512i sd1 = load_side8(side + i + 8);
+        __mmask8 m0 = _mm512_cmpgt_epi64_mask(sd0, zero);
+        __mmask8 m1 = _mm512_cmpgt_epi64_mask(sd1, zero);
+        __m512d v0 = _mm512_loadu_pd(volume + i);
+        __m512d v1 = _mm512_loadu_pd(volume + i + 8);
+        b0 = _mm512_mask_add_pd(b0, m0, b0, v0);
+        s0 = _mm512_mask_add_pd(s0, static_cast<__mmask8>(~m0), s0, v0);
+        b1 = _mm512_mask_add_pd(b1, m1, b1, v1);
+        s1 = _mm512_mask_add_pd(s1, static_cast<__mmask8>(~m1), s1, v1);
+    }
+    if (i + 8 <= n) {
+        __m512i sd0 = load_side8(side + i);
+        __mmask8 m0 = _mm512_cmpgt_epi64_mask(sd0, zero);
+        __m512d v0 = _mm512_loadu_pd(volume + i);
+        b0 = _mm512_mask_add_pd(b0, m0, b0, v0);
+        s0 = _mm512_mask_add_pd(s0, static_cast<__mmask8>(~m0), s0, v0);
+        i += 8;
+    }
+    double b = hsum8(_mm512_add_pd(b0, b1));
+    double s = hsum8(_mm512_add_pd(s0, s1));
+    for (; i < n; ++i) {
+        if (side[i] > 0) b += volume[i];
+        else s += volume[i];
+    }
+    *buy = b;
+    *sell = s;
+}
+
+#endif  // SWEEP_X86_DISPATCH
+
+bool kernel_supported(VolumeKernel kernel) {
+    switch (kernel) {
+    case VolumeKernel::Auto:
+    case VolumeKernel::Scalar:
+        return true;
+#ifdef SWEEP_X86_DISPATCH
+    case VolumeKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case VolumeKernel::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+SegmentSum segment_sum_for(VolumeKernel kernel) {
+    switch (kernel) {
+#ifdef SWEEP_X86_DISPATCH
+    case VolumeKernel::AVX2:
+        return segment_sum_avx2;
+    case VolumeKernel::AVX512:
+        return segment_sum_avx512;
+#endif
+    default:
+        return segment_sum_scalar;
+    }
+}
+
+// 第一个 i >= from 使 pred(i) 为假（pred 在 [from, n) 上先真后假）
+// 指针每次通常只前进几格：先倍增步长找到区间，再二分
+template <typename Pred>
+std::size_t gallop(std::size_t from, std::size_t n, Pred pred) {
+    if (from >= n || !pred(from)) return from;
+    std::size_t good = from;  // pred(good) 为真
+    std::size_t step = 1;
+    std::size_t bad = from + 1;
+    while (bad < n && pred(bad)) {
+        good = bad;
+        step *= 2;
+        bad = good + step;
+    }
+    if (bad > n) bad = n;
+    while (bad - good > 1) {
+        std::size_t mid = good + (bad - good) / 2;
+        if (pred(mid)) good = mid;
+        else bad = mid;
+    }
+    return bad;
+}
+
+}  // namespace
+
+VolumeKernel best_volume_kernel() {
+    static const VolumeKernel best = [] {
+        if (kernel_supported(VolumeKernel::AVX512)) return VolumeKernel::AVX512;
+        if (kernel_supported(VolumeKernel::AVX2)) return VolumeKernel::AVX2;
+        return VolumeKernel::Scalar;
+    }();
+    return best;
+}
+
+const char* volume_kernel_name(VolumeKernel kernel) {
+    switch (kernel) {
+    case VolumeKernel::Auto:   return "auto";
+    case VolumeKernel::Scalar: return "scalar";
+    case VolumeKernel::AVX2:   return "avx2";
+    case VolumeKernel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+void compute_window_volumes(const double* ts, const double* volume, const int8_t* side,
+                            std::size_t n,
+                            const double* query_ts, std::size_t n_query,
+                            const double* horizons, std::size_t n_horizons,
+                            double* buy_out, double* sell_out,
+                            double* buy_share_out, double* sell_share_out,
+                            VolumeKernel kernel) {
+    if (!kernel_supported(kernel)) {
+        throw std::invalid_argument(std::string("window volumes: kernel ") +
+                                    volume_kernel_name(kernel) + " is not supported on this CPU");
+    }
+    for (std::size_t k = 0; k < n_horizons; ++k) {
+        if (!(horizons[k] >= 0.0)) {
+            throw std::invalid_argument("window volumes: horizons must be >= 0");
+        }
+    }
+    if (kernel == VolumeKernel::Auto) kernel = best_volume_kernel();
+    const SegmentSum wide_sum = segment_sum_for(kernel);
+    // 密集查询时每段只有几笔，向量化不划算，直接标量累加
+    auto segment_sum = [wide_sum](const double* v, const int8_t* sd, std::size_t len,
+                                  double* buy, double* sell) {
+        if (len >= 16) wide_sum(v, sd, len, buy, sell);
+        else segment_sum_scalar(v, sd, len, buy, sell);
+    };
+
+    // 查询时刻通常已有序（帧时间网格），这时不排序
+    std::vector<std::size_t> order(n_query);
+    std::iota(order.begin(), order.end(), 0);
+    if (!std::is_sorted(query_ts, query_ts + n_query)) {
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return query_ts[a] < query_ts[b];
+        });
+    }
+
+    // 各 horizon 的窗口 [lo[k], hi)，hi 为第一条 ts > q，所有 horizon 共用
+    std::vector<std::size_t> lo(n_horizons, 0);
+    std::vector<double> buy(n_horizons, 0.0), sell(n_horizons, 0.0);
+    std::size_t hi = 0;
+
+    for (std::size_t j : order) {
+        const double q = query_ts[j];
+
+        // 新进窗口的成交对所有 horizon 都一样，只求一次
+        std::size_t new_hi = gallop(hi, n, [&](std::size_t i) { return ts[i] <= q; });
+        double add_buy = 0.0, add_sell = 0.0;
+        if (new_hi > hi) segment_sum(volume + hi, side + hi, new_hi - hi, &add_buy, &add_sell);
+        hi = new_hi;
+
+        for (std::size_t k = 0; k < n_horizons; ++k) {
+            const double h = horizons[k];
+            buy[k] += add_buy;
+            sell[k] += add_sell;
+
+            // 过期判断与提取器相同：q - ts > h
+            std::size_t new_lo = gallop(lo[k], hi, [&](std::size_t i) { return q - ts[i] > h; });
+            if (new_lo > lo[k]) {
+                double rm_buy, rm_sell;
+                segment_sum(volume + lo[k], side + lo[k], new_lo - lo[k], &rm_buy, &rm_sell);
+                buy[k] -= rm_buy;
+                sell[k] -= rm_sell;
+                lo[k] = new_lo;
+            }
+            if (lo[k] == hi) {
+                // 窗口已空：清零，避免加减累积的浮点误差
+                buy[k] = 0.0;
+                sell[k] = 0.0;
+            }
+
+            const std::size_t out = j * n_horizons + k;
+            const double b = buy[k], s = sell[k];
+            if (buy_out) buy_out[out] = b;
+            if (sell_out) sell_out[out] = s;
+            double tot = b + s;
+            double buy_share = tot > 0.0 ? b / tot : 0.0;
+            if (buy_share_out) buy_share_out[out] = buy_share;
+            if (sell_share_out) sell_share_out[out] = tot > 0.0 ? 1.0 - buy_share : 0.0;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+// cpp/volume_windows.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// === 离线多窗口买卖量：K 个 horizon × N 个查询时刻 ===
+// 查询时刻 q、窗口 h 统计的成交为 ts <= q 且 q - ts <= h 的那些，
+// 与 OrderFlowFeatureExtractor 在 q 时刻（已加入 ts <= q 的成交）取帧的 *_vol_* / *_share_* 口径一致：
+//   buy / sell：窗口内 side > 0 / 其余成交的量之和
+//   buy_share / sell_share：buy / (buy + sell) 与 1 - buy_share，窗口为空时都为 0
+// 累加顺序与逐笔增量不同，和提取器的结果只在末位有差异；所以 ReplayEngine 仍走提取器的增量窗口
+// （每笔 O(1)，帧与实盘逐位一致），这里只用于离线回填 / 批量 API
+//
+// ts / volume / side 为列式成交（同 Backtester::run），须按 ts 升序；查询时刻顺序任意
+// 每个 horizon 用双指针 + 分段求和，O(n * K + N * K)；较长的段（稀疏查询 / 长 horizon）
+// 用 AVX2 / AVX-512 求和，运行时按 CPU 选择，其余标量
+// 输出为 [查询][horizon] 行主序，各 n_query * n_horizons 个；不需要的输出可传 nullptr
+
+enum class VolumeKernel : uint8_t { Auto = 0, Scalar = 1, AVX2 = 2, AVX512 = 3 };
+
+// 本机可用的最佳实现（Auto 解析成的那个）
+VolumeKernel best_volume_kernel();
+const char* volume_kernel_name(VolumeKernel kernel);
+
+// kernel：Auto 自动选择；指定本机不支持的实现抛 std::invalid_argument（用于对拍 / 基准）
+void compute_window_volumes(const double* ts, const double* volume, const int8_t* side,
+                            std::size_t n,
+                            const double* query_ts, std::size_t n_query,
+                            const double* horizons, std::size_t n_horizons,
+                            double* buy_out, double* sell_out,
+                            double* buy_share_out, double* sell_share_out,
+                            VolumeKernel kernel = VolumeKernel::Auto);
@@ -0,0 +1,74 @@
+"""
+Decode the binary event journal written by EventJournal (live_bybit_strategy: JOURNAL_PATH).
+Prints one CSV row per record: sweeps and strategy actions in sequence order.
+"""
+
+import argparse
+import csv
+import sys
+
+from sweep_core import (
+    JournalKind,
+    JournalReader,
+    StrategyActionType,
+)
+
+
+COLUMNS = ["seq", "local_ns", "exchange_ts", "symbol", "kind", "action", "dir",
+           "price", "ts_start", "price_start", "volume"]
+
+
+def parse_args():
+    ap = argparse.ArgumentParser(description="Decode a binary sweep / action journal to CSV.")
+    ap.add_argument("journal", help="Journal file written by EventJournal")
+    ap.add_argument("--out", default="-", help="Output CSV path ('-' for stdout)")
+    ap.add_argument("--kind", choices=["all", "sweep", "action"], default="all",
+                    help="Only decode one record kind")
+    ap.add_argument("--symbols", default="",
+                    help="Comma-separated symbol names in id order (SymbolEngine.symbols); ids are printed otherwise")
+    ap.add_argument("--tail", type=int, default=0, help="Only the last N records (0 means all)")
+    return ap.parse_args()
+
+
+def main():
+    args = parse_args()
+    reader = JournalReader(args.journal)
+    rec = reader.records
+    if args.kind != "all":
+        kind = JournalKind.Sweep if args.kind == "sweep" else JournalKind.Action
+        rec = rec[rec["kind"] == int(kind)]
+    if args.tail > 0:
+        rec = rec[-args.tail:]
+
+    kind_names = {int(v): k for k, v in JournalKind.__members__.items()}
+    action_names = {int(v): k for k, v in StrategyActionType.__members__.items()}
+    symbols = args.symbols.split(",") if args.symbols else []
+
+    out = sys.stdout if args.out == "-" else open(args.out, "w", newline="")
+    try:
+        w = csv.writer(out)
+        w.writerow(COLUMNS)
+        for r in rec.tolist():
+            seq, local_ns, exchange_ts, symbol, kind, action, direction, _pad, \
+                price, ts_start, price_start, volume = r
+            is_sweep = kind == int(JournalKind.Sweep)
+            w.writerow([
+                seq, local_ns, f"{exchange_ts:.6f}",
+                symbols[symbol] if symbol < len(symbols) else symbol,
+                kind_names.get(kind, kind),
+                "" if is_sweep else action_names.get(action, action),
+                direction, price,
+                f"{ts_start:.6f}" if is_sweep else "",
+                price_start if is_sweep else "",
+                volume if is_sweep else "",
+            ])
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+    print(f"# {len(reader)} records, capacity={reader.capacity}, dropped={reader.dropped}, "
+          f"closed_cleanly={reader.closed_cleanly}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
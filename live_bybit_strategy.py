@@ -10,13 +10,16 @@ import requests
 import websocket  # pip install websocket-client
 
 from sweep_core import (
-    Tick,
-    Side,
     SweepModel,
-    SweepSignal,
-    SweepEventMeta,
+    SweepBaseline,
     MeanReversionStrategy,
     StrategyActionType,
+    BybitFeedHandler,
+    BybitRecordDecoder,
+    MarketQueue,
+    EventJournal,
+    latency_enabled,
+    latency_snapshot,
 )
 
 # ================== 日志配置 & 基本配置 ==================
@@ -24,6 +27,10 @@ from sweep_core import (
 LOG_PATH = os.getenv("LOG_PATH", "strategy.log")
 log_fp = open(LOG_PATH, "a", buffering=1)
 
+# sweep 事件 / 策略动作逐条写进二进制日志（C++ 内记录，不经过 Python 格式化）
+# 查看：python decode_journal.py strategy.journal
+JOURNAL_PATH = os.getenv("JOURNAL_PATH", "strategy.journal")
+
 
 def log(msg: str):
     ts = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime())
@@ -57,6 +64,9 @@ SWEEP_SHORT_WIN_SEC = 0.30
 SWEEP_LONG_WIN_SEC = 10.0
 # 最松先触发：只要短期量略高于长期均值就触发
 SWEEP_THRESHOLD_RATIO = 1.0  # 原 3.0 -> 1.2 -> 1.0
+# Window：存 SWEEP_LONG_WIN_SEC 内全部 tick；Ewma：衰减速率基线（SWEEP_LONG_WIN_SEC 为时间常数，
+# 只存短窗口内的 tick，可以放长到几分钟 / 几小时）；EwmaZ：再按 z-score 触发（阈值即 z）
+SWEEP_BASELINE = SweepBaseline.Window
 
 # ======== 策略本身参数（和 C++ 构造函数 4 个参数一一对应） ========
 DELAY_MS = 5.0    # 近乎即时跟单
@@ -66,20 +76,32 @@ SL_BP    = 8.0    # 更宽的止损，容忍误触发回撤
 
 # ================== C++ 实例 ==================
 
-# 负责从 tick 中检测 sweep
-sweep_model = SweepModel(
-    short_window_sec=SWEEP_SHORT_WIN_SEC,
-    long_window_sec=SWEEP_LONG_WIN_SEC,
-    threshold_ratio=SWEEP_THRESHOLD_RATIO,
+# 原始消息直接交给 C++：解析 + sweep 检测 + on_sweep / on_tick 全在 C++ 内完成
+# model / strategy 按值拷进 feed，之后读状态用 feed.model / feed.strategy
+feed = BybitFeedHandler(
+    SYMBOL,
+    model=SweepModel(
+        short_window_sec=SWEEP_SHORT_WIN_SEC,
+        long_window_sec=SWEEP_LONG_WIN_SEC,
+        threshold_ratio=SWEEP_THRESHOLD_RATIO,
+        baseline=SWEEP_BASELINE,
+    ),
+    strategy=MeanReversionStrategy(
+        delay_ms=DELAY_MS,
+        hold_sec=HOLD_SEC,
+        tp_bp=TP_BP,
+        sl_bp=SL_BP,
+    ),
 )
 
-# 负责基于 sweep + tick 做反向均值回归
-strategy = MeanReversionStrategy(
-    delay_ms=DELAY_MS,
-    hold_sec=HOLD_SEC,
-    tp_bp=TP_BP,
-    sl_bp=SL_BP,
-)
+# 已有的日志文件接着追加
+journal = EventJournal(JOURNAL_PATH)
+feed.set_journal(journal)
+
+# WS 回调线程只解析入队，策略线程取出计算：下单 / 写日志慢也不耽误读 socket
+market_queue = MarketQueue(capacity=65536)
+decoder = BybitRecordDecoder(SYMBOL)
+QUEUE_STATS_SEC = 30.0
 
 # 当前仓位方向（只做 1 仓位的简单版本）
 current_pos_dir = 0  # 0 = 无仓, +1 = long, -1 = short
@@ -217,53 +239,47 @@ def on_open(ws):
     log(f"Subscribed: {TOPIC}")
 
 
+def on_action(act):
+    # 动作本身已由 C++ 写进 journal，这里打日志 + 下单
+    log(f"[ACT] {act.type.name} dir={act.dir} ts={act.ts:.3f} price={act.price}")
+    handle_action(act)
+
+
+last_sweeps = 0
+
+
+def log_new_sweeps():
+    # 每个 sweep 都在 journal 里；一次 drain 里有多个时日志只展开最后一个
+    global last_sweeps
+    n = feed.stats.sweeps
+    if n == last_sweeps:
+        return
+    ev = feed.model.get_last_event()
+    log(f"[SWEEP] new={n - last_sweeps} dir={ev.direction} ts={ev.ts_end:.3f} "
+        f"price_end={ev.price_end} vol={ev.volume_total:.2f}")
+    last_sweeps = n
+
+
 def on_message(ws, message):
     try:
-        data = json.loads(message)
-        if data.get("topic") != TOPIC:
-            return
-        trades = data.get("data") or []
-        if not trades:
-            return
-
-        for t in trades:
-            # Bybit publicTrade v5
-            ts = float(t["T"]) / 1000.0
-            price = float(t["p"])
-            vol = float(t["v"])
-            side = Side.Buy if t["S"] == "Buy" else Side.Sell
-
-            # 1) tick 喂给 SweepModel 做 sweep 检测
-            tick = Tick()
-            tick.timestamp = ts
-            tick.price = price
-            tick.volume = vol
-            tick.side = side
-
-            sig = sweep_model.process_tick(tick)
-
-            if sig != SweepSignal.NoSignal:
-                ev = sweep_model.get_last_event()  # SweepEventMeta
-                log(f"[SWEEP] sig={sig.name} dir={ev.direction} "
-                    f"ts={ev.ts_end:.3f} price_end={ev.price_end} vol={ev.volume_total:.2f}")
-                # 这一步是 “sweep 触发 → 反向均值回归 策略的 on_sweep”
-                act_from_sweep = strategy.on_sweep(ev)
-                if act_from_sweep.type != StrategyActionType.Idle:
-                    log(f"[ACT] from_sweep {act_from_sweep}")
-                handle_action(act_from_sweep)
-
-            # 2) 无论是否有 sweep，都给策略一个 on_tick 用来管理持仓
-            #    注意：这里 C++ 的 on_tick(ts, price) 只吃两个 double
-            act_from_tick = strategy.on_tick(ts, price)
-            if act_from_tick.type != StrategyActionType.Idle:
-                log(f"[ACT] from_tick {act_from_tick}")
-            handle_action(act_from_tick)
-
+        # 只解析入队；队列满时整条丢弃，计入 market_queue.dropped（盘口消息另计 book_gaps）
+        decoder.push(message, market_queue)
     except Exception as e:
         log(f"[WS ERROR] exception in on_message: {e}")
         traceback.print_exc()
 
 
+def strategy_loop():
+    while True:
+        try:
+            # 等待时释放 GIL；只有产生非 Idle 动作时才回调 Python
+            feed.drain(market_queue, on_action, timeout=0.1)
+            log_new_sweeps()
+        except Exception as e:
+            log(f"[STRATEGY ERROR] exception in drain: {e}")
+            traceback.print_exc()
+
+
 def on_error(ws, error):
     log(f"[WS ERROR] {error}")
 
@@ -294,14 +310,37 @@ def ws_loop():
 
 def main():
     log(f"Starting live strategy for {SYMBOL}, MODE={MODE}")
+    strategy_thread = threading.Thread(target=strategy_loop, daemon=True)
+    strategy_thread.start()
     ws_thread = threading.Thread(target=ws_loop, daemon=True)
     ws_thread.start()
 
     try:
+        last_stats = time.time()
         while True:
             time.sleep(1)
+            if time.time() - last_stats >= QUEUE_STATS_SEC:
+                last_stats = time.time()
+                q = market_queue
+                log(f"[QUEUE] depth={q.depth} max_depth={q.max_depth} pushed={q.pushed} "
+                    f"dropped={q.dropped} dropped_msgs={q.dropped_messages} "
+                    f"book_gaps={decoder.stats.book_gaps} book_skipped={decoder.stats.book_skipped}")
+                if feed.book_stale:
+                    # 丢过盘口增量：簿已清空，等下一条 snapshot（Bybit 需重新订阅盘口 topic）
+                    log("[QUEUE] order book stale after a dropped update, waiting for snapshot")
+                log(f"[JOURNAL] committed={journal.committed} dropped={journal.dropped}")
+                if journal.full:
+                    log(f"[JOURNAL] full (capacity={journal.capacity}), new records are dropped; "
+                        f"restart with a new JOURNAL_PATH")
+                if latency_enabled:
+                    for stage, h in latency_snapshot().items():
+                        if h["count"]:
+                            log(f"[LATENCY] {stage} n={h['count']} p50={h['p50_ns']}ns "
+                                f"p99={h['p99_ns']}ns p99.9={h['p999_ns']}ns max={h['max_ns']}ns")
     except KeyboardInterrupt:
         log("Main loop interrupted, exit.")
+    finally:
+        journal.close()
 
 
 if __name__ == "__main__":
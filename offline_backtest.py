@@ -6,13 +6,17 @@ Default ticks file: ticks_eth.csv (ts, price, volume, side[B/S]).
 import argparse
 import csv
 
+import numpy as np
+
 from sweep_core import (
     SweepModel,
+    SweepBaseline,
     Side,
-    Tick,
-    SweepSignal,
     MeanReversionStrategy,
-    StrategyActionType,
+    Backtester,
+    FillModel,
+    LatencyDist,
+    TickStore,
 )
 
 
@@ -29,8 +33,20 @@ SL_BP = 8.0
 
 def parse_args():
     ap = argparse.ArgumentParser(description="Offline backtest for sweep + strategy.")
-    ap.add_argument("--ticks", default="ticks_eth.csv", help="CSV with columns ts,price,volume,side[B/S]")
+    ap.add_argument("--ticks", default="ticks_eth.csv", help="CSV with columns ts,price,volume,side[B/S], or a .bin tick store")
     ap.add_argument("--limit", type=int, default=0, help="Max rows to replay (0 means all).")
+    # ewma / ewmaz 不存长窗口 tick：--long-win-sec 为 EWMA 时间常数，可以取到分钟 / 小时级
+    ap.add_argument("--baseline", choices=["window", "ewma", "ewmaz"], default="window",
+                    help="Sweep volume baseline: stored long window, EWMA rate, or EWMA z-score.")
+    ap.add_argument("--long-win-sec", type=float, default=SWEEP_LONG_WIN_SEC,
+                    help="Long window (window) or EWMA time constant (ewma / ewmaz), seconds.")
+    ap.add_argument("--threshold", type=float, default=SWEEP_THRESHOLD_RATIO,
+                    help="Volume ratio threshold (z-score threshold with --baseline ewmaz).")
+    # 成交模拟：只有成交数据，市价单按订单到达时的最新成交价成交
+    ap.add_argument("--fill", action="store_true", help="Simulate fills with latency and fees instead of ideal fills.")
+    ap.add_argument("--latency-ms", type=float, default=0.0, help="Fixed order latency (ms), with --fill.")
+    ap.add_argument("--jitter-ms", type=float, default=0.0, help="Mean of the exponential latency tail (ms), with --fill.")
+    ap.add_argument("--taker-fee-bp", type=float, default=0.0, help="Taker fee per side (bp), with --fill.")
     return ap.parse_args()
 
 
@@ -50,13 +66,31 @@ def load_ticks(path, limit=0):
                 break
 
 
+def load_columns(path, limit=0):
+    """把 tick 读成 ts/price/volume/side 四列 NumPy 数组（side: +1=Buy, -1=Sell）"""
+    ts, price, vol, side = [], [], [], []
+    for t, p, v, sd in load_ticks(path, limit):
+        ts.append(t)
+        price.append(p)
+        vol.append(v)
+        side.append(1 if sd == Side.Buy else -1)
+    return (
+        np.asarray(ts, dtype=np.float64),
+        np.asarray(price, dtype=np.float64),
+        np.asarray(vol, dtype=np.float64),
+        np.asarray(side, dtype=np.int8),
+    )
+
+
 def main():
     args = parse_args()
 
     sweep_model = SweepModel(
         short_window_sec=SWEEP_SHORT_WIN_SEC,
-        long_window_sec=SWEEP_LONG_WIN_SEC,
-        threshold_ratio=SWEEP_THRESHOLD_RATIO,
+        long_window_sec=args.long_win_sec,
+        threshold_ratio=args.threshold,
+        baseline={"window": SweepBaseline.Window, "ewma": SweepBaseline.Ewma,
+                  "ewmaz": SweepBaseline.EwmaZ}[args.baseline],
     )
     strategy = MeanReversionStrategy(
         delay_ms=DELAY_MS,
@@ -65,69 +99,43 @@ def main():
         sl_bp=SL_BP,
     )
 
-    current_dir = 0
-    entry_price = None
-    wins = 0
-    losses = 0
-    cum_pnl = 0.0
-
-    sweep_cnt = 0
-    open_cnt = 0
-    close_cnt = 0
-
-    for ts, price, vol, side in load_ticks(args.ticks, args.limit):
-        # Sweep detection
-        tick = Tick()
-        tick.timestamp = ts
-        tick.price = price
-        tick.volume = vol
-        tick.side = side
-
-        sig = sweep_model.process_tick(tick)
-        if sig != SweepSignal.NoSignal:
-            sweep_cnt += 1
-            ev = sweep_model.get_last_event()
-            act = strategy.on_sweep(ev)
-            if act.type == StrategyActionType.OpenLong:
-                current_dir = 1
-                entry_price = act.price
-                open_cnt += 1
-            elif act.type == StrategyActionType.OpenShort:
-                current_dir = -1
-                entry_price = act.price
-                open_cnt += 1
-            elif act.type == StrategyActionType.Close and current_dir != 0 and entry_price is not None:
-                pnl = (act.price - entry_price) * current_dir
-                cum_pnl += pnl
-                if pnl > 0:
-                    wins += 1
-                elif pnl < 0:
-                    losses += 1
-                current_dir = 0
-                entry_price = None
-                close_cnt += 1
-
-        # Position management
-        act_tick = strategy.on_tick(ts, price)
-        if act_tick.type == StrategyActionType.Close and current_dir != 0 and entry_price is not None:
-            pnl = (act_tick.price - entry_price) * current_dir
-            cum_pnl += pnl
-            if pnl > 0:
-                wins += 1
-            elif pnl < 0:
-                losses += 1
-            current_dir = 0
-            entry_price = None
-            close_cnt += 1
-
-    total_trades = wins + losses
-    win_rate = wins / total_trades * 100 if total_trades > 0 else 0.0
-
-    print(f"Replayed ticks: {args.limit or 'all'} from {args.ticks}")
-    print(f"Sweeps detected: {sweep_cnt}")
-    print(f"Opens: {open_cnt}, Closes: {close_cnt}")
-    print(f"Wins: {wins}, Losses: {losses}, WinRate: {win_rate:4.1f}%")
-    print(f"Cum PnL (mark): {cum_pnl:.6f}")
+    if args.ticks.endswith(".bin"):
+        # 二进制 tick 文件：mmap 零拷贝，直接拿列视图
+        store = TickStore(args.ticks)
+        n = args.limit or len(store)
+        ts, price, vol, side = store.ts[:n], store.price[:n], store.volume[:n], store.side[:n]
+    else:
+        ts, price, vol, side = load_columns(args.ticks, args.limit)
+
+    # 整段回放在 C++ 内完成，Python 只拿结果
+    if args.fill:
+        fill = FillModel(
+            latency=LatencyDist.Exponential if args.jitter_ms > 0 else LatencyDist.Fixed,
+            latency_ms=args.latency_ms,
+            jitter_ms=args.jitter_ms,
+            taker_fee_bp=args.taker_fee_bp,
+        )
+        bt = Backtester(sweep_model, strategy, fill)
+    else:
+        bt = Backtester(sweep_model, strategy)
+    bt.run(ts, price, vol, side)
+    st = bt.stats
+    trades = bt.trades()
+
+    total_trades = st.wins + st.losses
+    win_rate = st.wins / total_trades * 100 if total_trades > 0 else 0.0
+
+    print(f"Replayed ticks: {st.ticks} from {args.ticks}")
+    print(f"Sweeps detected: {st.sweeps}")
+    print(f"Opens: {st.opens}, Closes: {st.closes}")
+    print(f"Wins: {st.wins}, Losses: {st.losses}, WinRate: {win_rate:4.1f}%")
+    print(f"Cum PnL (bp): {st.cum_pnl_bp:.3f}")
+    if len(trades) > 0:
+        print(f"Avg PnL per trade (bp): {trades['pnl_bp'].mean():.3f}")
+    fs = bt.fill_stats
+    if fs is not None:
+        print(f"Fills: market={fs.market_fills}, limit={fs.limit_fills}, missed entries={fs.missed_entries}")
+        print(f"Slippage (bp): {fs.slippage_bp:.3f}, Fees (bp): {fs.fees_bp:.3f}")
 
 
 if __name__ == "__main__":
@@ -3,6 +3,8 @@ from dataclasses import dataclass
 from typing import List, Tuple
 import numpy as np
 
+from sweep_core import PriceMoveDetector, event_returns
+
 # === 前瞻窗口 ===
 T_HORIZON = 30.0  # 30 秒
 
@@ -170,15 +172,30 @@ def summarize(label: str, arr: np.ndarray) -> str:
     )
 
 
+def to_columns(ticks: List[TickRow]):
+    ts = np.array([t.ts for t in ticks], dtype=np.float64)
+    price = np.array([t.price for t in ticks], dtype=np.float64)
+    vol = np.array([t.vol for t in ticks], dtype=np.float64)
+    side = np.array([t.side for t in ticks], dtype=np.int8)
+    return ts, price, vol, side
+
+
 def main():
     ticks = load_ticks("ticks_eth.csv")
     print(f"[INFO] loaded {len(ticks)} ticks from ticks_eth.csv")
+    ts, price, vol, side = to_columns(ticks)
+    horizons = np.array([T_HORIZON])
 
+    # 检测与前瞻收益都在 C++ 里做；detect_sweeps_py / compute_ret_stats 保留作口径参考
     for w in WINDOW_LIST:
         for bp in PRICE_BP_LIST:
             for vol_min in VOL_MIN_LIST:
-                sweeps = detect_sweeps_py(ticks, w, bp, vol_min)
-                down_rets, up_rets = compute_ret_stats(ticks, sweeps)
+                det = PriceMoveDetector(w, bp, vol_min)
+                _, sweeps = det.process_ticks(ts, price, vol, side, flush=True)
+                ret = event_returns(ts, price, sweeps, horizons)["ret"][:, 0]
+                ok = ~np.isnan(ret)
+                down_rets = ret[ok & (sweeps["direction"] < 0)]
+                up_rets = ret[ok & (sweeps["direction"] >= 0)]
 
                 print("=" * 80)
                 print(